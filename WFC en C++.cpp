@@ -6,6 +6,10 @@
 #include "overlapping_model.h"
 #include "simpletiled_model.h"
 #include "execution_data.h"
+#include "batch_runner.h"
+#include "chunk_generator.h"
+#include "block_solver.h"
+#include "benchmark.h"
 
 #include <iostream>
 #include <filesystem>
@@ -17,6 +21,72 @@ using namespace std;
 
 namespace txml = tinyxml2;
 
+// Construye el modelo descrito por un elemento del XML con sus opciones de ejecución, usando threads hilos
+// donde el modelo reparte su construcción
+static Model* LoadModel(txml::XMLElement* xelem, int threads)
+{
+    Model* model = nullptr;
+    string name = string(xelem->Attribute("name"));
+
+    bool isOverlapping = string(xelem->Name()) == "overlapping";
+    int size = xelem->IntAttribute("size", isOverlapping ? 48 : 24);
+    int width = xelem->IntAttribute("width", size);
+    int height = xelem->IntAttribute("height", size);
+    bool periodic = xelem->BoolAttribute("periodic", false);
+
+    const char* heuristicAux = xelem->Attribute("heuristic");
+    string heuristicString = (heuristicAux != nullptr) ? string(heuristicAux) : "Entropy";
+    Model::Heuristic heuristic = (heuristicString == "Scanline") ? Model::Heuristic::Scanline :
+        (heuristicString == "MRV") ? Model::Heuristic::MRV :
+        Model::Heuristic::Entropy;
+
+    if (isOverlapping)
+    {
+        int N = xelem->IntAttribute("N", 3);
+        bool periodicInput = xelem->BoolAttribute("periodicInput", true);
+        int symmetry = xelem->IntAttribute("symmetry", 8);
+        bool ground = xelem->BoolAttribute("ground", false);
+
+        model = new OverlappingModel(name, N, width, height, periodicInput, periodic, symmetry, ground, heuristic, threads);
+    }
+    else
+    {
+        const char* subsetAux = xelem->Attribute("subset");
+        string subset = (subsetAux != nullptr) ? string(subsetAux) : "";
+        bool blackBackground = xelem->BoolAttribute("blackBackground", false);
+
+        model = new SimpleTiledModel(name, subset, width, height, periodic, blackBackground, heuristic);
+    }
+    model->backtrackLimit = xelem->IntAttribute("backtracks", 0);
+
+    const char* engineAux = xelem->Attribute("engine");
+    string engineString = (engineAux != nullptr) ? string(engineAux) : "Auto";
+    model->engine = (engineString == "Bitset") ? Model::Engine::Bitset :
+        (engineString == "AC4") ? Model::Engine::AC4 :
+        Model::Engine::Auto;
+
+    return model;
+}
+
+// Devuelve la función que guarda la salida de una ejecución con éxito; se llama desde los hilos del lote,
+// cada uno con su propio Solver
+static function<void(const Solver&, int)> OutputSaver(txml::XMLElement* xelem, Model* model, const string& name)
+{
+    bool textOutput = string(xelem->Name()) != "overlapping" && xelem->BoolAttribute("textOutput", false);
+    return [model, name, textOutput](const Solver& solver, int seed)
+    {
+        model->Save(solver, "output/" + name + " " + to_string(seed) + ".png");
+
+        // Si es un modelo SimpleTiledModel, generar salida en texto si se requiere
+        if (textOutput)
+        {
+            SimpleTiledModel* stmodel = dynamic_cast<SimpleTiledModel*>(model);
+            ofstream textOut("output/" + name + " " + to_string(seed) + ".txt");
+            textOut << stmodel->TextOutput(solver);
+        }
+    };
+}
+
 int main()
 {
     // Inicialización del cronómetro
@@ -39,70 +109,85 @@ int main()
     txml::XMLElement* root = doc.RootElement();
 
     txml::XMLElement* execution = root->FirstChildElement("execution");
+
+    // Hilos con los que se resuelven las ejecuciones de cada muestra; con 0 se usan todos los núcleos
+    int threads = execution->IntAttribute("threads", 0);
     if (string(execution->Attribute("type")) == "Classic")
     {
         for (txml::XMLElement* xelem = execution->NextSiblingElement(); xelem != nullptr; xelem = xelem->NextSiblingElement())
         {
-            Model* model = nullptr;
             string name = string(xelem->Attribute("name"));
             cout << "< " << name << endl;
 
+            Model* model = LoadModel(xelem, threads);
             bool isOverlapping = string(xelem->Name()) == "overlapping";
             int size = xelem->IntAttribute("size", isOverlapping ? 48 : 24);
             int width = xelem->IntAttribute("width", size);
             int height = xelem->IntAttribute("height", size);
-            bool periodic = xelem->BoolAttribute("periodic", false);
-
-            const char* heuristicAux = xelem->Attribute("heuristic");
-            string heuristicString = (heuristicAux != nullptr) ? string(heuristicAux) : "Entropy";
-            Model::Heuristic heuristic = (heuristicString == "Scanline") ? Model::Heuristic::Scanline :
-                (heuristicString == "MRV") ? Model::Heuristic::MRV :
-                Model::Heuristic::Entropy;
-
-            if (isOverlapping)
-            {
-                int N = xelem->IntAttribute("N", 3);
-                bool periodicInput = xelem->BoolAttribute("periodicInput", true);
-                int symmetry = xelem->IntAttribute("symmetry", 8);
-                bool ground = xelem->BoolAttribute("ground", false);
-
-                model = new OverlappingModel(name, N, width, height, periodicInput, periodic, symmetry, ground, heuristic);
-            }
-            else
-            {
-                const char* subsetAux = xelem->Attribute("subset");
-                string subset = (subsetAux != nullptr) ? string(subsetAux) : "";
-                bool blackBackground = xelem->BoolAttribute("blackBackground", false);
-
-                model = new SimpleTiledModel(name, subset, width, height, periodic, blackBackground, heuristic);
-            }
 
             int screenshots = xelem->IntAttribute("screenshots", 2);
             int tries = 10;
-            for (int s = 0; s < screenshots; s++)
+
+            // Cada hilo guarda la salida de las ejecuciones que resuelve con su propio Solver
+            auto save = OutputSaver(xelem, model, name);
+
+            int chunks = xelem->IntAttribute("chunks", 0);
+            if (chunks > 0)
             {
-                for (int t = 0; t < tries; t++)
+                // Cada salida es un mundo de chunks x chunks trozos del tamaño indicado, generados por filas
+                for (int s = 0; s < screenshots; s++)
                 {
-                    cout << "> ";
-                    int seed = random();
-                    bool success = model->Run(seed, xelem->IntAttribute("limit", -1));
-                    if (success)
+                    int worldSeed = random();
+                    ChunkGenerator generator(*model, width, height, worldSeed, tries);
+                    for (int cy = 0; cy < chunks; cy++)
                     {
-                        cout << "DONE" << endl;
-                        model->Save("output/" + name + " " + to_string(seed) + ".png");
-
-                        // Si es un modelo SimpleTiledModel, generar salida en texto si se requiere
-                        if (!isOverlapping && xelem->BoolAttribute("textOutput", false))
+                        for (int cx = 0; cx < chunks; cx++)
                         {
-                            SimpleTiledModel* stmodel = dynamic_cast<SimpleTiledModel*>(model);
-                            ofstream textOut("output/" + name + " " + to_string(seed) + ".txt");
-                            textOut << stmodel->TextOutput();
+                            bool success = generator.Generate(cx, cy);
+                            cout << "> chunk (" << cx << ", " << cy << ") " << (success ? "DONE" : "CONTRADICTION") << endl;
+                            if (success) generator.Save(cx, cy, "output/" + name + " " + to_string(worldSeed) + " " + to_string(cx) + " " + to_string(cy) + ".png");
                         }
-                        break;
                     }
-                    else
+                }
+            }
+            else if (xelem->IntAttribute("blockSize", 0) > 0)
+            {
+                // Salidas grandes resueltas por bloques solapados; solo se guarda un patrón por celda
+                int blockSize = xelem->IntAttribute("blockSize", 0);
+                BlockSolver blockSolver(*model, width, height, blockSize, xelem->IntAttribute("blockOverlap", blockSize / 4), tries);
+                for (int s = 0; s < screenshots; s++)
+                {
+                    int seed = random();
+                    bool success = blockSolver.Run(seed);
+                    cout << "> " << (success ? "DONE" : "CONTRADICTION");
+                    if (blockSolver.Retries() > 0) cout << " (" << blockSolver.Retries() << " blocks re-solved)";
+                    cout << endl;
+                    if (success) blockSolver.Save("output/" + name + " " + to_string(seed) + ".png");
+                }
+            }
+            else if (xelem->BoolAttribute("race", false))
+            {
+                // Cada salida lanza sus intentos a la vez y se queda con el primero que termina
+                BatchRunner runner(*model, threads);
+                for (int s = 0; s < screenshots; s++)
+                {
+                    RaceResult result = runner.Race(random(), tries, xelem->IntAttribute("limit", -1), save);
+                    cout << "> " << (result.success ? "DONE" : "CONTRADICTION") << " (" << result.Wasted() << " of " << result.launched
+                        << " speculative runs wasted: " << result.contradictions << " contradictions, " << result.cancelled << " cancelled)" << endl;
+                }
+            }
+            else
+            {
+                BatchRunner runner(*model, threads);
+                vector<BatchResult> results = runner.Run(random(), screenshots, tries, xelem->IntAttribute("limit", -1), save);
+                for (const BatchResult& result : results)
+                {
+                    for (int c = 0; c < result.contradictions; c++) cout << "> CONTRADICTION" << endl;
+                    if (result.success)
                     {
-                        cout << "CONTRADICTION" << endl;
+                        cout << "> DONE";
+                        if (result.backtracks > 0) cout << " (" << result.backtracks << " backtracks)";
+                        cout << endl;
                     }
                 }
             }
@@ -110,78 +195,71 @@ int main()
             delete model; // Liberar la memoria al final de cada iteración
         }
     }
-    else // string(execution->Attribute("type")) == "Analysis"
+    else if (string(execution->Attribute("type")) == "Benchmark")
     {
+        // Primero el coste de las operaciones por celda aislado y después el tiempo por ejecución de cada muestra
+        BenchmarkCellLayout(execution->IntAttribute("cells", 1 << 16), execution->IntAttribute("operations", 1 << 24), random());
+
         for (txml::XMLElement* xelem = execution->NextSiblingElement(); xelem != nullptr; xelem = xelem->NextSiblingElement())
         {
-            Model* model = nullptr;
             string name = string(xelem->Attribute("name"));
-            
-            bool isOverlapping = string(xelem->Name()) == "overlapping";
-            int size = xelem->IntAttribute("size", isOverlapping ? 48 : 24);
-            int width = xelem->IntAttribute("width", size);
-            int height = xelem->IntAttribute("height", size);
-            bool periodic = xelem->BoolAttribute("periodic", false);
 
-            const char* heuristicAux = xelem->Attribute("heuristic");
-            string heuristicString = (heuristicAux != nullptr) ? string(heuristicAux) : "Entropy";
-            Model::Heuristic heuristic = (heuristicString == "Scanline") ? Model::Heuristic::Scanline :
-                (heuristicString == "MRV") ? Model::Heuristic::MRV :
-                Model::Heuristic::Entropy;
+            Model* model = LoadModel(xelem, threads);
+            shared_ptr<const Ruleset> rules = model->Rules();
 
-            if (isOverlapping)
-            {
-                int N = xelem->IntAttribute("N", 3);
-                bool periodicInput = xelem->BoolAttribute("periodicInput", true);
-                int symmetry = xelem->IntAttribute("symmetry", 8);
-                bool ground = xelem->BoolAttribute("ground", false);
+            int screenshots = xelem->IntAttribute("screenshots", 10);
+            int limit = xelem->IntAttribute("limit", -1);
 
-                model = new OverlappingModel(name, N, width, height, periodicInput, periodic, symmetry, ground, heuristic);
-            }
-            else
+            // Una línea por instancia del núcleo: motor y ancho de contador los fija el Ruleset, la heurística cada Solver
+            string engine = rules->engine == Ruleset::Engine::Bitset ? "Bitset" :
+                "AC4 " + to_string(8 * rules->counterBytes) + "-bit" + (rules->classCounters ? " classes" : "");
+            const vector<pair<Model::Heuristic, string>> heuristics = {
+                { Model::Heuristic::Entropy, "Entropy" }, { Model::Heuristic::MRV, "MRV" }, { Model::Heuristic::Scanline, "Scanline" }
+            };
+            for (const auto& [heuristic, heuristicName] : heuristics)
             {
-                const char* subsetAux = xelem->Attribute("subset");
-                string subset = (subsetAux != nullptr) ? string(subsetAux) : "";
-                bool blackBackground = xelem->BoolAttribute("blackBackground", false);
+                Solver solver(rules, heuristic, model->backtrackLimit);
+                int contradictions = 0;
 
-                model = new SimpleTiledModel(name, subset, width, height, periodic, blackBackground, heuristic);
+                auto benchStart = chrono::high_resolution_clock::now();
+                for (int s = 0; s < screenshots; s++)
+                {
+                    if (!solver.Run(random(), limit)) contradictions++;
+                }
+                chrono::duration<double, milli> benchElapsed = chrono::high_resolution_clock::now() - benchStart;
+
+                cout << name << " [" << engine << ", " << heuristicName << (rules->periodic ? ", periodic" : "") << "]: "
+                    << benchElapsed.count() / screenshots << " ms/run (" << screenshots << " runs, " << contradictions << " contradictions)" << endl;
             }
 
+            delete model;
+        }
+    }
+    else // string(execution->Attribute("type")) == "Analysis"
+    {
+        for (txml::XMLElement* xelem = execution->NextSiblingElement(); xelem != nullptr; xelem = xelem->NextSiblingElement())
+        {
+            string name = string(xelem->Attribute("name"));
+            
+            Model* model = LoadModel(xelem, threads);
+
             int screenshots = xelem->IntAttribute("screenshots", 10);
             int tries = 10;
             ExecutionData* data = new ExecutionData(name, screenshots, tries);
-            for (int s = 0; s < screenshots; s++)
-            {
-                int contradictions = 0;
-                auto execStart = chrono::high_resolution_clock::now();
-                
-                for (int t = 0; t < tries; t++)
-                {
-                    int seed = random();
-                    bool success = model->Run(seed, xelem->IntAttribute("limit", -1));
-                    if (success)
-                    {
-                        model->Save("output/" + name + " " + to_string(seed) + ".png");
 
-                        // Si es un modelo SimpleTiledModel, generar salida en texto si se requiere
-                        if (!isOverlapping && xelem->BoolAttribute("textOutput", false))
-                        {
-                            SimpleTiledModel* stmodel = dynamic_cast<SimpleTiledModel*>(model);
-                            ofstream textOut("output/" + name + " " + to_string(seed) + ".txt");
-                            textOut << stmodel->TextOutput();
-                        }
-                        break;
-                    }
-                    else
-                    {
-                        ++contradictions;
-                    }
-                }
-                data->SetContradictions(contradictions, s);
+            // Cada hilo guarda la salida de las ejecuciones que resuelve con su propio Solver
+            auto save = OutputSaver(xelem, model, name);
 
-                auto execFinish = chrono::high_resolution_clock::now();
-                chrono::duration<double, milli> execElapsed = execFinish - execStart;
-                data->SetDuration(execElapsed, s);
+            // Los resultados se vuelcan en ExecutionData cuando termina el lote, desde este hilo
+            BatchRunner runner(*model, threads);
+            auto batchStart = chrono::high_resolution_clock::now();
+            vector<BatchResult> results = runner.Run(random(), screenshots, tries, xelem->IntAttribute("limit", -1), save);
+            data->SetElapsed(chrono::high_resolution_clock::now() - batchStart);
+            for (int s = 0; s < screenshots; s++)
+            {
+                data->SetContradictions(results[s].contradictions, s);
+                data->SetBacktracks(results[s].backtracks, results[s].restartSaved, s);
+                data->SetDuration(results[s].duration, s);
             }
             data->PrintResults();
 
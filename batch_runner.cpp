@@ -0,0 +1,80 @@
+#include "batch_runner.h"
+
+using namespace std;
+
+BatchRunner::BatchRunner(Model& model, int threads) : model(model), pool(threads), solvers(pool.Size()) {
+    // Las reglas se construyen aqu, en un solo hilo, y los workers solo las comparten
+    model.Rules();
+}
+
+// Cada worker solo toca su propia posicin, as que no hace falta sincronizar la creacin
+Solver& BatchRunner::WorkerSolver(int worker) {
+    if (!solvers[worker]) solvers[worker] = model.CreateSolver();
+    return *solvers[worker];
+}
+
+vector<BatchResult> BatchRunner::Run(int firstSeed, int count, int tries, int limit, const function<void(const Solver&, int)>& onSuccess) {
+    // Cada ejecucin escribe solo en su propia posicin, as que no hace falta sincronizar los resultados
+    vector<BatchResult> results(count);
+
+    pool.Run(count, [&](int worker, int e) {
+        Solver& solver = WorkerSolver(worker);
+        BatchResult& result = results[e];
+        result = { firstSeed, false, 0, 0, false, {} };
+        auto execStart = chrono::high_resolution_clock::now();
+
+        for (int t = 0; t < tries; ++t) {
+            // Las semillas dependen solo de la posicin en el lote, no del hilo que la ejecute
+            result.seed = static_cast<int>(static_cast<unsigned>(firstSeed) + static_cast<unsigned>(e) * tries + t);
+            result.success = solver.Run(result.seed, limit);
+            result.backtracks += solver.Backtracks();
+            if (result.success) {
+                // Sin backtracking esta ejecucin habra terminado en contradiccin
+                result.restartSaved = solver.Backtracks() > 0;
+                onSuccess(solver, result.seed);
+                break;
+            }
+            ++result.contradictions;
+        }
+
+        result.duration = chrono::high_resolution_clock::now() - execStart;
+    });
+
+    return results;
+}
+
+RaceResult BatchRunner::Race(int firstSeed, int tries, int limit, const function<void(const Solver&, int)>& onSuccess) {
+    atomic<bool> finished(false);
+    atomic<int> launched(0), contradictions(0), cancelled(0);
+    RaceResult result = { firstSeed, false, 0, 0, 0, {} };
+    auto raceStart = chrono::high_resolution_clock::now();
+
+    pool.Run(tries, [&](int worker, int t) {
+        if (finished.load()) return;
+        ++launched;
+
+        Solver& solver = WorkerSolver(worker);
+        int seed = static_cast<int>(static_cast<unsigned>(firstSeed) + t);
+        if (!solver.Run(seed, limit, &finished)) {
+            // Una ejecucin cortada por la bandera no lleg a una contradiccin
+            if (solver.ContradictionNode() >= 0) ++contradictions;
+            else ++cancelled;
+            return;
+        }
+
+        // Solo la primera en activar la bandera gana; el resto de soluciones se descartan
+        bool expected = false;
+        if (finished.compare_exchange_strong(expected, true)) {
+            result.seed = seed;
+            result.success = true;
+            onSuccess(solver, seed);
+        }
+        else ++cancelled;
+    });
+
+    result.launched = launched;
+    result.contradictions = contradictions;
+    result.cancelled = cancelled;
+    result.duration = chrono::high_resolution_clock::now() - raceStart;
+    return result;
+}
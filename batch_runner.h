@@ -0,0 +1,64 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include <atomic>
+
+#include "model.h"
+#include "solver.h"
+#include "work_stealing_pool.h"
+
+using namespace std;
+
+// Resultado de una ejecucin del lote: la semilla que tuvo xito (o la ltima probada) y sus estadsticas
+struct BatchResult {
+	int seed;
+	bool success;
+	int contradictions;
+	int backtracks;
+	bool restartSaved;
+	chrono::duration<double, milli> duration;
+};
+
+// Resultado de una carrera: la semilla ganadora y cuntas ejecuciones especulativas no sirvieron para nada
+struct RaceResult {
+	int seed;
+	bool success;
+	int launched;
+	int contradictions;
+	int cancelled;
+	chrono::duration<double, milli> duration;
+
+	int Wasted() const { return launched - (success ? 1 : 0); }
+};
+
+// Ejecuta muchas semillas de un mismo modelo en paralelo, con un Solver por hilo sobre el Ruleset compartido
+class BatchRunner {
+
+private:
+	Model& model;
+	WorkStealingPool pool;
+
+	// Cada Solver ocupa una onda y unos contadores completos, as que se crea con la primera tarea de su worker
+	vector<unique_ptr<Solver>> solvers;
+
+	Solver& WorkerSolver(int worker);
+
+public:
+	BatchRunner(Model& model, int threads);
+
+	int Threads() const { return pool.Size(); }
+
+	// Lanza count ejecuciones; la ejecucin e prueba como mucho tries semillas consecutivas desde firstSeed + e * tries.
+	// onSuccess se llama desde el hilo que la resolvi, con su Solver, para guardar la salida
+	vector<BatchResult> Run(int firstSeed, int count, int tries, int limit, const function<void(const Solver&, int)>& onSuccess);
+
+	// Lanza a la vez las semillas firstSeed .. firstSeed + tries - 1 para una sola salida. La primera que termina
+	// con xito llama a onSuccess y cancela a las dems; las que an no haban empezado ya no se lanzan
+	RaceResult Race(int firstSeed, int tries, int limit, const function<void(const Solver&, int)>& onSuccess);
+};
+
+#endif
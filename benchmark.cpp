@@ -0,0 +1,90 @@
+#include "benchmark.h"
+#include "ruleset.h"
+
+#include <random>
+
+using namespace std;
+
+// Cada operacin prohbe un patrn en una celda al azar y la marca; cada cierto nmero de operaciones se recalcula
+// la clave de las celdas marcadas, como hace NextUnobservedNode con su lista de celdas sucias
+static const int dirtyFlush = 64;
+
+void BenchmarkCellLayout(int cells, int operations, int seed) {
+    mt19937 random(seed);
+    uniform_int_distribution<int> cell(0, cells - 1);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+
+    vector<int> targets(operations);
+    vector<double> weights(operations);
+    for (int k = 0; k < operations; ++k) {
+        targets[k] = cell(random);
+        weights[k] = unit(random);
+    }
+    vector<double> noise(cells);
+    for (int i = 0; i < cells; ++i) noise[i] = unit(random) * 1E-6;
+
+    vector<int> dirty;
+    dirty.reserve(dirtyFlush);
+    double sink = 0;
+
+    // Vectores separados, como estaban antes de agrupar el estado en CellState
+    vector<int> sumsOfOnes(cells, 1 << 20);
+    vector<double> sumsOfWeights(cells, 1E9), sumsOfWeightLogWeights(cells, 1E9), noises(noise);
+    vector<uint8_t> isDirty(cells, 0);
+
+    auto start = chrono::high_resolution_clock::now();
+    for (int k = 0; k < operations; ++k) {
+        int i = targets[k];
+        double w = weights[k];
+        sumsOfOnes[i] -= 1;
+        sumsOfWeights[i] -= w;
+        sumsOfWeightLogWeights[i] -= w * 0.5;
+        if (!isDirty[i]) {
+            isDirty[i] = 1;
+            dirty.push_back(i);
+        }
+
+        if (dirty.size() == dirtyFlush || k + 1 == operations) {
+            for (int j : dirty) {
+                isDirty[j] = 0;
+                double sum = sumsOfWeights[j];
+                sink += log(sum) - sumsOfWeightLogWeights[j] / sum + noises[j] + sumsOfOnes[j];
+            }
+            dirty.clear();
+        }
+    }
+    chrono::duration<double, nano> separate = chrono::high_resolution_clock::now() - start;
+
+    // Un registro alineado por celda
+    AlignedVector<CellState> states(cells);
+    for (int i = 0; i < cells; ++i) states[i] = { 1E9, 1E9, noise[i], 1 << 20, 0 };
+
+    start = chrono::high_resolution_clock::now();
+    for (int k = 0; k < operations; ++k) {
+        CellState& state = states[targets[k]];
+        double w = weights[k];
+        state.sumOfOnes -= 1;
+        state.sumOfWeights -= w;
+        state.sumOfWeightLogWeights -= w * 0.5;
+        if (!state.dirty) {
+            state.dirty = 1;
+            dirty.push_back(targets[k]);
+        }
+
+        if (dirty.size() == dirtyFlush || k + 1 == operations) {
+            for (int j : dirty) {
+                CellState& flushed = states[j];
+                flushed.dirty = 0;
+                double sum = flushed.sumOfWeights;
+                sink += log(sum) - flushed.sumOfWeightLogWeights / sum + flushed.noise + flushed.sumOfOnes;
+            }
+            dirty.clear();
+        }
+    }
+    chrono::duration<double, nano> packed = chrono::high_resolution_clock::now() - start;
+
+    cout << "Cell layout (" << cells << " cells, " << operations << " operations):" << endl;
+    cout << "  separate vectors: " << separate.count() / operations << " ns/op" << endl;
+    cout << "  CellState:        " << packed.count() / operations << " ns/op" << endl;
+    if (sink == 0) cout << endl; // Evita que el compilador descarte los bucles
+}
@@ -0,0 +1,15 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+
+// Microbenchmark del estado por celda: compara las sumas, el ruido y la marca repartidos en vectores separados
+// con el registro CellState del Solver, con el patrn de acceso de Ban y de la seleccin de la siguiente celda.
+// Imprime los nanosegundos por operacin de cada disposicin
+void BenchmarkCellLayout(int cells, int operations, int seed);
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef BIT_HELPER_H
+#define BIT_HELPER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+// Cuenta los bits activos de una palabra de 64 bits
+inline int Popcount(uint64_t w) {
+#if defined(_MSC_VER) && defined(_M_X64)
+	return static_cast<int>(__popcnt64(w));
+#elif defined(__GNUC__)
+	return __builtin_popcountll(w);
+#else
+	int count = 0;
+	for (; w; w &= w - 1) ++count;
+	return count;
+#endif
+}
+
+// Devuelve la posicin del bit activo menos significativo (w no puede ser 0)
+inline int CountTrailingZeros(uint64_t w) {
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, w);
+	return static_cast<int>(index);
+#elif defined(__GNUC__)
+	return __builtin_ctzll(w);
+#else
+	int index = 0;
+	while (!(w & 1)) { w >>= 1; ++index; }
+	return index;
+#endif
+}
+
+// Reservador que alinea los bloques a una lnea de cach (64 bytes)
+template <typename T, size_t Alignment = 64>
+struct AlignedAllocator {
+	using value_type = T;
+
+	template <typename U>
+	struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+	AlignedAllocator() noexcept {}
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+	T* allocate(size_t n) {
+		return static_cast<T*>(::operator new(n * sizeof(T), align_val_t(Alignment)));
+	}
+
+	void deallocate(T* p, size_t) noexcept {
+		::operator delete(p, align_val_t(Alignment));
+	}
+
+	template <typename U>
+	bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+	template <typename U>
+	bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+template <typename T>
+using AlignedVector = vector<T, AlignedAllocator<T>>;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "block_solver.h"
+
+using namespace std;
+
+BlockSolver::BlockSolver(const Model& model, int width, int height, int blockSize, int overlap, int tries)
+    : model(model), width(width), height(height), blockSize(blockSize), overlap(overlap), tries(tries), retries(0) {
+    if (blockSize - 2 * overlap <= 0) throw runtime_error("Block size must be larger than twice the overlap");
+}
+
+Solver& BlockSolver::SolverFor(int blockWidth, int blockHeight) {
+    unique_ptr<Solver>& solver = solvers[{ blockWidth, blockHeight }];
+    if (!solver) solver = make_unique<Solver>(model.ChunkRules(blockWidth, blockHeight), model.heuristic, model.backtrackLimit);
+    return *solver;
+}
+
+bool BlockSolver::Run(int seed) {
+    committed.assign(size_t(width) * height, -1);
+    retries = 0;
+
+    // Los ncleos recorren la salida por filas, as que cada bloque tiene confirmados su lado izquierdo y el de arriba
+    int core = blockSize - 2 * overlap;
+    int block = 0;
+    for (int coreY = 0; coreY < height; coreY += core) {
+        for (int coreX = 0; coreX < width; coreX += core, ++block) {
+            if (!SolveBlock(coreX, coreY, static_cast<int>(static_cast<unsigned>(seed) + static_cast<unsigned>(block) * tries))) return false;
+        }
+    }
+    return true;
+}
+
+// Ante una contradiccin solo se vuelve a resolver este bloque, con la siguiente semilla
+bool BlockSolver::SolveBlock(int coreX, int coreY, int seed) {
+    int core = blockSize - 2 * overlap;
+    int x0 = max(0, coreX - overlap), y0 = max(0, coreY - overlap);
+    int x1 = min(width, coreX + core + overlap), y1 = min(height, coreY + core + overlap);
+    int blockWidth = x1 - x0, blockHeight = y1 - y0;
+    Solver& solver = SolverFor(blockWidth, blockHeight);
+
+    for (int i = 0; i < blockWidth * blockHeight; ++i) {
+        int x = x0 + i % blockWidth, y = y0 + i / blockWidth;
+        int t = committed[x + y * width];
+        if (t >= 0) {
+            solver.ConstrainPattern(i, t);
+            continue;
+        }
+
+        // Una celda libre del borde del bloque debe encajar con las celdas confirmadas que tiene fuera
+        for (int d = 0; d < 4; ++d) {
+            int nx = x - Ruleset::directionX[d], ny = y - Ruleset::directionY[d];
+            if (nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+            if (nx >= x0 && nx < x1 && ny >= y0 && ny < y1) continue;
+
+            int t2 = committed[nx + ny * width];
+            if (t2 >= 0) solver.ConstrainNeighbor(i, d, t2);
+        }
+    }
+
+    bool success = false;
+    for (int t = 0; t < tries && !success; ++t) {
+        success = solver.Run(static_cast<int>(static_cast<unsigned>(seed) + t), -1);
+        if (!success) ++retries;
+    }
+
+    if (success) {
+        const vector<int>& observed = solver.Observed();
+        for (int y = coreY; y < min(height, coreY + core); ++y)
+            for (int x = coreX; x < min(width, coreX + core); ++x)
+                committed[x + y * width] = observed[(x - x0) + (y - y0) * blockWidth];
+    }
+    solver.ClearConstraints();
+
+    return success;
+}
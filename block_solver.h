@@ -0,0 +1,48 @@
+#ifndef BLOCK_SOLVER_H
+#define BLOCK_SOLVER_H
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+#include <stdexcept>
+
+#include "model.h"
+#include "ruleset.h"
+#include "solver.h"
+
+using namespace std;
+
+// Resuelve una salida de width x height celdas demasiado grande para una sola onda, bloque a bloque.
+// Cada bloque es un ncleo de blockSize - 2 * overlap celdas de lado ms un margen de overlap celdas alrededor:
+// las celdas ya confirmadas del margen se fijan, el resto sirve de anticipo y solo se confirma el ncleo.
+// La memoria de la onda depende del tamao de bloque; de la salida completa solo se guarda un patrn por celda
+class BlockSolver {
+
+private:
+	const Model& model;
+	int width, height, blockSize, overlap, tries;
+
+	// Patrn confirmado en cada celda de la salida, o -1 si an no se ha resuelto
+	vector<int> committed;
+	int retries;
+
+	// Los bloques del borde se recortan, as que hay un Solver por cada tamao de bloque distinto
+	map<pair<int, int>, unique_ptr<Solver>> solvers;
+
+	Solver& SolverFor(int blockWidth, int blockHeight);
+	bool SolveBlock(int coreX, int coreY, int seed);
+
+public:
+	BlockSolver(const Model& model, int width, int height, int blockSize, int overlap, int tries = 10);
+
+	// Devuelve false si algn bloque no encuentra solucin en tries intentos
+	bool Run(int seed);
+
+	const vector<int>& Observed() const { return committed; }
+	int Retries() const { return retries; }
+
+	void Save(const string& filename) const { model.SaveObserved(committed, width, height, filename); }
+};
+
+#endif
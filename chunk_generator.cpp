@@ -0,0 +1,66 @@
+#include "chunk_generator.h"
+
+using namespace std;
+
+ChunkGenerator::ChunkGenerator(const Model& model, int chunkWidth, int chunkHeight, int worldSeed, int tries)
+    : model(model), rules(model.ChunkRules(chunkWidth, chunkHeight)), solver(rules, model.heuristic, model.backtrackLimit),
+    chunkWidth(chunkWidth), chunkHeight(chunkHeight), worldSeed(worldSeed), tries(tries) {}
+
+// Mezcla de splitmix64: trozos contiguos reciben semillas sin relacin aparente
+static uint64_t Mix(uint64_t z) {
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int ChunkGenerator::ChunkSeed(int cx, int cy, int t) const {
+    uint64_t h = Mix(static_cast<uint32_t>(worldSeed));
+    h = Mix(h ^ static_cast<uint32_t>(cx));
+    h = Mix(h ^ static_cast<uint32_t>(cy));
+    h = Mix(h ^ static_cast<uint32_t>(t));
+    return static_cast<int>(static_cast<uint32_t>(h));
+}
+
+// Cada celda del borde que da a un trozo cargado solo admite los patrones compatibles con la celda de enfrente
+void ChunkGenerator::ConstrainBorders(int cx, int cy) {
+    for (int d = 0; d < 4; ++d) {
+        // La celda de este trozo queda en la direccin d respecto a la del vecino
+        int dx = Ruleset::directionX[d], dy = Ruleset::directionY[d];
+        auto neighbor = chunks.find({ cx - dx, cy - dy });
+        if (neighbor == chunks.end()) continue;
+
+        for (int i = 0; i < chunkWidth * chunkHeight; ++i) {
+            int nx = i % chunkWidth - dx, ny = i / chunkWidth - dy;
+            if (nx >= 0 && nx < chunkWidth && ny >= 0 && ny < chunkHeight) continue;
+
+            nx = (nx + chunkWidth) % chunkWidth;
+            ny = (ny + chunkHeight) % chunkHeight;
+            solver.ConstrainNeighbor(i, d, neighbor->second[nx + ny * chunkWidth]);
+        }
+    }
+}
+
+bool ChunkGenerator::Generate(int cx, int cy) {
+    if (IsLoaded(cx, cy)) return true;
+
+    ConstrainBorders(cx, cy);
+    bool success = false;
+    for (int t = 0; t < tries && !success; ++t) {
+        success = solver.Run(ChunkSeed(cx, cy, t), -1);
+        if (success) chunks[{ cx, cy }] = solver.Observed();
+    }
+    solver.ClearConstraints();
+
+    return success;
+}
+
+const vector<int>& ChunkGenerator::Chunk(int cx, int cy) const {
+    auto chunk = chunks.find({ cx, cy });
+    if (chunk == chunks.end()) throw runtime_error("Chunk (" + to_string(cx) + ", " + to_string(cy) + ") is not loaded");
+    return chunk->second;
+}
+
+void ChunkGenerator::Save(int cx, int cy, const string& filename) const {
+    model.SaveObserved(Chunk(cx, cy), chunkWidth, chunkHeight, filename);
+}
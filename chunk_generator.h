@@ -0,0 +1,50 @@
+#ifndef CHUNK_GENERATOR_H
+#define CHUNK_GENERATOR_H
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+
+#include "model.h"
+#include "ruleset.h"
+#include "solver.h"
+
+using namespace std;
+
+// Genera bajo demanda un mundo ilimitado dividido en trozos de chunkWidth x chunkHeight celdas.
+// Cada trozo se resuelve con una semilla que solo depende de (worldSeed, cx, cy) y con sus bordes
+// restringidos por los trozos vecinos que ya estn cargados. Solo ocupan memoria los trozos vivos
+class ChunkGenerator {
+
+private:
+	const Model& model;
+	shared_ptr<const Ruleset> rules;
+	Solver solver;
+
+	int chunkWidth, chunkHeight;
+	int worldSeed, tries;
+
+	// Patrn observado en cada celda de cada trozo cargado
+	map<pair<int, int>, vector<int>> chunks;
+
+	int ChunkSeed(int cx, int cy, int t) const;
+	void ConstrainBorders(int cx, int cy);
+
+public:
+	ChunkGenerator(const Model& model, int chunkWidth, int chunkHeight, int worldSeed, int tries = 10);
+
+	// Devuelve false si ninguna de las semillas del trozo encaja con sus vecinos
+	bool Generate(int cx, int cy);
+
+	bool IsLoaded(int cx, int cy) const { return chunks.count({ cx, cy }) > 0; }
+	const vector<int>& Chunk(int cx, int cy) const;
+	void Unload(int cx, int cy) { chunks.erase({ cx, cy }); }
+	int LiveChunks() const { return static_cast<int>(chunks.size()); }
+
+	void Save(int cx, int cy, const string& filename) const;
+};
+
+#endif
@@ -8,21 +8,34 @@ ExecutionData::ExecutionData(const string& name, int exec, int numTries) {
     tries = numTries;
 
     contradictions = vector<int>(executions, 0);
+    backtracks = vector<int>(executions, 0);
+    restartsSaved = vector<bool>(executions, false);
     durations = vector<chrono::duration<double, milli>>(executions);
+    elapsed = chrono::duration<double, milli>(0);
 }
 
 void ExecutionData::SetContradictions(int c, int execID) {
     contradictions[execID] = c;
 }
 
+void ExecutionData::SetBacktracks(int b, bool restartSaved, int execID) {
+    backtracks[execID] = b;
+    restartsSaved[execID] = restartSaved;
+}
+
 void ExecutionData::SetDuration(chrono::duration<double, milli> d, int execID) {
     durations[execID] = d;
 }
 
+// Tiempo real de todo el lote; las ejecuciones se solapan en varios hilos, as que no es la suma de sus duraciones
+void ExecutionData::SetElapsed(chrono::duration<double, milli> d) {
+    elapsed = d;
+}
+
 void ExecutionData::PrintResults() {
     cout << "Results for -" << sampleName << "- sample (" << tries << " tries per execution, " << executions << " executions):" << endl << endl;
 
-    int fails = 0;
+    int fails = 0, totalBacktracks = 0, totalRestartsSaved = 0;
     double contradictionsMean = 0;
     auto now = chrono::high_resolution_clock::now();
     chrono::duration<double, milli> duration = now - now;
@@ -31,6 +44,8 @@ void ExecutionData::PrintResults() {
     {
         contradictions[exec] == tries ? ++fails : contradictionsMean += contradictions[exec];
         duration += durations[exec];
+        totalBacktracks += backtracks[exec];
+        totalRestartsSaved += restartsSaved[exec];
     }
 
     cout << "* " << fails << " executions didn't find a solution in " << tries << " tries." << endl;
@@ -44,8 +59,14 @@ void ExecutionData::PrintResults() {
     }
     else cout << endl;
 
+    if (totalBacktracks > 0)
+    {
+        cout << "* Backtracking undid " << totalBacktracks << " decisions and saved " << totalRestartsSaved << " restarts." << endl << endl;
+    }
+
     double durationMean = duration.count();
-    cout << "* In total, all the execution's duration was " << durationMean << " miliseconds." << endl;
+    cout << "* The whole batch took " << elapsed.count() << " miliseconds of wall-clock time." << endl;
+    cout << "* Added up, the executions ran for " << durationMean << " miliseconds (they may overlap on several threads)." << endl;
 
     durationMean /= double(executions);
     cout << "* This makes for a mean of " << durationMean << " miliseconds per execution." << endl << endl;
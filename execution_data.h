@@ -15,13 +15,18 @@ private:
 	int tries;
 
 	vector<int> contradictions;
+	vector<int> backtracks;
+	vector<bool> restartsSaved;
 	vector<chrono::duration<double, milli>> durations;
+	chrono::duration<double, milli> elapsed;
 
 public:
 	ExecutionData(const string& name, int exec, int numTries);
 
 	void SetContradictions(int c, int execID);
+	void SetBacktracks(int b, bool restartSaved, int execID);
 	void SetDuration(chrono::duration<double, milli> d, int execID);
+	void SetElapsed(chrono::duration<double, milli> d);
 
 	void PrintResults();
 };
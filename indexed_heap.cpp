@@ -0,0 +1,70 @@
+#include "indexed_heap.h"
+
+using namespace std;
+
+// Vaca el montculo y lo prepara para ndices en [0, capacity)
+void IndexedHeap::Reset(int capacity) {
+    heap.clear();
+    heap.reserve(capacity);
+    positions.assign(capacity, -1);
+    keys.resize(capacity);
+}
+
+void IndexedHeap::Push(int item, double key) {
+    keys[item] = key;
+    heap.push_back(item);
+    positions[item] = static_cast<int>(heap.size()) - 1;
+    SiftUp(positions[item]);
+}
+
+// La clave puede subir o bajar, as que se intenta recolocar en ambos sentidos
+void IndexedHeap::Update(int item, double key) {
+    double old = keys[item];
+    keys[item] = key;
+    if (key < old) SiftUp(positions[item]);
+    else SiftDown(positions[item]);
+}
+
+void IndexedHeap::Remove(int item) {
+    int k = positions[item];
+    int last = heap.back();
+    heap.pop_back();
+    positions[item] = -1;
+    if (last == item) return;
+
+    Place(last, k);
+    SiftUp(k);
+    SiftDown(positions[last]);
+}
+
+void IndexedHeap::Place(int item, int k) {
+    heap[k] = item;
+    positions[item] = k;
+}
+
+void IndexedHeap::SiftUp(int k) {
+    int item = heap[k];
+    double key = keys[item];
+    while (k > 0) {
+        int parent = (k - 1) / 2;
+        if (keys[heap[parent]] <= key) break;
+        Place(heap[parent], k);
+        k = parent;
+    }
+    Place(item, k);
+}
+
+void IndexedHeap::SiftDown(int k) {
+    int item = heap[k];
+    double key = keys[item];
+    int size = static_cast<int>(heap.size());
+    while (true) {
+        int child = 2 * k + 1;
+        if (child >= size) break;
+        if (child + 1 < size && keys[heap[child + 1]] < keys[heap[child]]) child++;
+        if (key <= keys[heap[child]]) break;
+        Place(heap[child], k);
+        k = child;
+    }
+    Place(item, k);
+}
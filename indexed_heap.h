@@ -0,0 +1,33 @@
+#ifndef INDEXED_HEAP_H
+#define INDEXED_HEAP_H
+
+#include <vector>
+
+using namespace std;
+
+// Montculo binario de mnimos sobre ndices de celda que recuerda la posicin de cada celda,
+// de modo que su clave se puede actualizar o eliminar en O(log n)
+class IndexedHeap {
+
+private:
+	vector<int> heap;
+	vector<int> positions;
+	vector<double> keys;
+
+	void SiftUp(int k);
+	void SiftDown(int k);
+	void Place(int item, int k);
+
+public:
+	void Reset(int capacity);
+
+	void Push(int item, double key);
+	void Update(int item, double key);
+	void Remove(int item);
+
+	bool Contains(int item) const { return positions[item] >= 0; }
+	bool Empty() const { return heap.empty(); }
+	int Top() const { return heap[0]; }
+};
+
+#endif
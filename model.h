@@ -9,50 +9,63 @@
 #include <numeric>
 #include <iostream>
 #include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "bit_helper.h"
+#include "propagator.h"
+#include "ruleset.h"
+#include "solver.h"
 
 using namespace std;
 
+// Un modelo extrae los patrones y las reglas de adyacencia de su entrada; el colapso lo realiza un Solver
+// sobre el Ruleset que se construye a partir de ellas
 class Model {
 
-private:
-	int NextUnobservedNode(mt19937& random);
-	void Observe(int node, mt19937& random);
-	bool Propagate();
-	void Ban(int i, int t);
-	void Clear();
-
 public:
-	enum Heuristic { Entropy, MRV, Scanline };
+	using Heuristic = Solver::Heuristic;
 	Heuristic heuristic;
 
+	// Nmero mximo de vueltas atrs por ejecucin; con 0 una contradiccin termina la ejecucin
+	int backtrackLimit;
+
+	// Motor de propagacin; se fija al construir el Ruleset, as que debe elegirse antes de Init
+	using Engine = Ruleset::Engine;
+	Engine engine;
+
 	Model(int width, int height, int N, bool periodic, Heuristic heuristic);
+	virtual ~Model() {}
 
 	void Init();
 	bool Run(int seed, int limit);
-	virtual void Save(const string& filename) = 0;
 
-protected:
-	vector<vector<bool>> wave;
-	vector<vector<vector<int>>> propagator;
-	vector<vector<vector<int>>> compatible;
-	vector<int> observed;
+	// Reglas compartidas y un Solver nuevo sobre ellas, para ejecutar varias semillas en paralelo
+	shared_ptr<const Ruleset> Rules();
+	unique_ptr<Solver> CreateSolver();
 
-	vector<pair<int, int>> stack;
-	int stacksize, observedSoFar;
+	// Reglas para trozos de width x height celdas sin bordes peridicos ni suelo, en las que cada celda es un patrn completo
+	shared_ptr<const Ruleset> ChunkRules(int width, int height) const;
 
+	virtual void Save(const Solver& solver, const string& filename) const = 0;
+	void Save(const string& filename) const { Save(*solver, filename); }
+
+	// Dibuja una rejilla de patrones ya observados de width x height celdas, como las de ChunkRules
+	virtual void SaveObserved(const vector<int>& observed, int width, int height, const string& filename) const = 0;
+
+	int Backtracks() const { return solver->Backtracks(); }
+	int ContradictionNode() const { return solver->ContradictionNode(); }
+
+protected:
 	int outputWidth, outputHeight, patternsTotal, patternSize;
 	bool periodic, ground;
 
 	vector<double> weights;
-	vector<double> weightLogWeights, distribution;
-
-	vector<int> sumsOfOnes;
-	double sumOfWeights, sumOfWeightLogWeights, startingEntropy;
-	vector<double> sumsOfWeights, sumsOfWeightLogWeights, entropies;
+	Propagator propagator;
 
-	static const vector<int> directionX;
-	static const vector<int> directionY;
-	static const vector<int> opposite;
+	shared_ptr<const Ruleset> ruleset;
+	unique_ptr<Solver> solver;
 };
 
-#endif
\ No newline at end of file
+#endif
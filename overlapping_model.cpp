@@ -2,7 +2,7 @@
 
 using namespace std;
 
-OverlappingModel::OverlappingModel(const string& name, int N, int width, int height, bool periodicInput, bool periodic, int symmetry, bool ground, Heuristic heuristic)
+OverlappingModel::OverlappingModel(const string& name, int N, int width, int height, bool periodicInput, bool periodic, int symmetry, bool ground, Heuristic heuristic, int threads)
     : Model(width, height, N, periodic, heuristic)
 {
     // Cargamos el bitmap
@@ -20,6 +20,8 @@ OverlappingModel::OverlappingModel(const string& name, int N, int width, int hei
 
         auto it = find(colors.begin(), colors.end(), color);
         if (it == colors.end()) {
+            // Los ndices se guardan en un byte: con ms colores se mezclaran colores y patrones distintos
+            if (colors.size() == 256) throw runtime_error("Sample " + name + " has more than 256 colors");
             colors.push_back(color);
             sample[i] = colors.size() - 1;
         }
@@ -28,135 +30,120 @@ OverlappingModel::OverlappingModel(const string& name, int N, int width, int hei
         }
     }
 
-    // Inicializamos las listas con los patrones, sus ndices y sus pesos
-    patterns.clear();
-    unordered_map<int64_t, int> patternIndices;
-    vector<double> weightList;
-
-    // Asignamos a C los colores nicos encontrados y definimos las posiciones de las que se extraern los patrones
-    int C = colors.size();
+    // Definimos las posiciones de las que se extraern los patrones
     int xmax = periodicInput ? SX : SX - patternSize + 1;
     int ymax = periodicInput ? SY : SY - patternSize + 1;
 
-    for (int y = 0; y < ymax; y++) {
-        for (int x = 0; x < xmax; x++) {
-            // Creamos un vector con 8 patrones, 4 son para el original y sus rotaciones, otros 4 para cada reflejo
-            vector<vector<uint8_t>> ps(8);
-
-            ps[0] = pattern([&](int dx, int dy) { return sample[(x + dx) % SX + (y + dy) % SY * SX]; }, patternSize);
-            ps[1] = reflect(ps[0], patternSize);
-            ps[2] = rotate(ps[0], patternSize);
-            ps[3] = reflect(ps[2], patternSize);
-            ps[4] = rotate(ps[2], patternSize);
-            ps[5] = reflect(ps[4], patternSize);
-            ps[6] = rotate(ps[4], patternSize);
-            ps[7] = reflect(ps[6], patternSize);
-
-            // Recorremos los niveles de simetra definidos
-            for (int k = 0; k < symmetry; k++) {
-                // Escogemos un patrn y creamos un hash
-                vector<uint8_t> p = ps[k];
-                int64_t h = hash(p, C);
-
-                // Buscamos su ndice para aumentar su peso o aadirlo
-                auto it = patternIndices.find(h);
-                if (it != patternIndices.end()) {
-                    weightList[it->second] += 1.0;
-                }
-                else {
-                    patternIndices[h] = weightList.size();
-                    weightList.push_back(1.0);
-                    patterns.push_back(p);
+    // Repartimos las filas en franjas y cada una cuenta sus patrones en su propia tabla, por orden de aparicin
+    int patternBytes = patternSize * patternSize;
+    WorkStealingPool pool(threads);
+    int stripesTotal = max(1, min(ymax, pool.Size() * 4));
+    vector<PatternPool> stripes(stripesTotal, PatternPool(patternBytes));
+
+    pool.Run(stripesTotal, [&](int, int s) {
+        PatternPool& stripe = stripes[s];
+        vector<vector<uint8_t>> ps(8, vector<uint8_t>(patternSize * patternSize));
+
+        for (int y = ymax * s / stripesTotal; y < ymax * (s + 1) / stripesTotal; y++) {
+            for (int x = 0; x < xmax; x++) {
+                // El original, sus rotaciones y el reflejo de cada una; solo se calculan los que pide la simetra
+                for (int dy = 0; dy < patternSize; dy++)
+                    for (int dx = 0; dx < patternSize; dx++) ps[0][dx + dy * patternSize] = sample[(x + dx) % SX + (y + dy) % SY * SX];
+                for (int k = 1; k < symmetry; k++) {
+                    if (k % 2 == 1) reflect(ps[k - 1], ps[k], patternSize);
+                    else rotate(ps[k - 2], ps[k], patternSize);
                 }
+
+                // Recorremos los niveles de simetra definidos, sumando peso a cada patrn o aadindolo
+                for (int k = 0; k < symmetry; k++) stripe.Add(ps[k].data());
             }
         }
+    });
+
+    // Juntamos las franjas en orden: los ndices y los pesos quedan como si se hubiera recorrido la muestra en un hilo
+    patterns = PatternPool(patternBytes);
+    for (const PatternPool& stripe : stripes) {
+        for (int t = 0; t < stripe.Count(); t++) patterns.Add(stripe.Pattern(t), stripe.PatternHash(t), stripe.Weight(t));
     }
 
     // Asignamos la lista de pesos y a T la cantidad de patrones nicos encontrados
-    weights = weightList;
+    weights = patterns.Weights();
     patternsTotal = weights.size();
     this->ground = ground;
 
-    // Inicializamos el propagador con 4 direcciones
-    propagator.resize(4);
-    for (int d = 0; d < 4; d++) {
-        // Cada direccin tiene un vector de tamao T (patrones nicos)
-        propagator[d].resize(patternsTotal);
+    // Inicializamos el propagador con 4 direcciones. Dos patrones son compatibles en la direccin d si la franja
+    // de t que queda bajo el vecino coincide con la franja opuesta de t2, as que agrupamos los patrones por esa
+    // franja opuesta y la lista de t es directamente el grupo de su franja, sin comparar todas las parejas.
+    // Las franjas se usan enteras como clave, de modo que una colisin del hash no puede juntar patrones distintos
+    vector<vector<vector<int>>> lists(4);
+    pool.Run(4, [&](int, int d) {
+        int dx = Ruleset::directionX[d], dy = Ruleset::directionY[d];
+        unordered_map<string, vector<int>> buckets;
+        for (int t2 = 0; t2 < patternsTotal; t2++) buckets[strip(patterns.Pattern(t2), -dx, -dy, patternSize)].push_back(t2);
+
+        // Cada lista queda en orden creciente de t2, como al recorrer todas las parejas
+        lists[d].resize(patternsTotal);
         for (int t = 0; t < patternsTotal; t++) {
-            // Cada patrn contiene la lista de patrones compatibles gracias a la funcin agrees
-            vector<int> list;
-            for (int t2 = 0; t2 < patternsTotal; t2++) {
-                if (agrees(patterns[t], patterns[t2], directionX[d], directionY[d], patternSize)) {
-                    list.push_back(t2);
-                }
-            }
-            propagator[d][t] = list;
+            auto it = buckets.find(strip(patterns.Pattern(t), dx, dy, patternSize));
+            if (it != buckets.end()) lists[d][t] = it->second;
         }
-    }
+    });
+
+    // Lo compilamos al formato CSR compartido por ambos modelos
+    propagator = Propagator(lists);
 }
 
-// Recibe una funcin desde rotate o reflect con la que procesar un patrn dado para devolverlo rotado o reflejado
-vector<uint8_t> OverlappingModel::pattern(function<uint8_t(int, int)> f, int N) {
-    vector<uint8_t> result(N * N);
+// Escribe en result el patrn p rotado
+void OverlappingModel::rotate(const vector<uint8_t>& p, vector<uint8_t>& result, int N) {
     for (int y = 0; y < N; y++) {
         for (int x = 0; x < N; x++) {
-            result[x + y * N] = f(x, y);
+            result[x + y * N] = p[N - 1 - y + x * N];
         }
     }
-    return result;
-}
-
-// Rota
-vector<uint8_t> OverlappingModel::rotate(const vector<uint8_t>& p, int N) {
-    return pattern([&](int x, int y) { return p[N - 1 - y + x * N]; }, N);
 }
 
-// Refleja
-vector<uint8_t> OverlappingModel::reflect(const vector<uint8_t>& p, int N) {
-    return pattern([&](int x, int y) { return p[N - 1 - x + y * N]; }, N);
-}
-
-// Crea un hash para el patrn dado en base a la cantidad de colores nicos existentes
-int64_t OverlappingModel::hash(const vector<uint8_t>& p, int C) {
-    int64_t result = 0;
-    int64_t power = 1;
-    for (size_t i = 0; i < p.size(); i++) {
-        result += p[p.size() - 1 - i] * power;
-        power *= C;
+// Escribe en result el patrn p reflejado
+void OverlappingModel::reflect(const vector<uint8_t>& p, vector<uint8_t>& result, int N) {
+    for (int y = 0; y < N; y++) {
+        for (int x = 0; x < N; x++) {
+            result[x + y * N] = p[N - 1 - x + y * N];
+        }
     }
-    return result;
 }
 
-// Comprueba si dos patrones son compatibles uno al lado del otro superponindose
-bool OverlappingModel::agrees(const vector<uint8_t>& p1, const vector<uint8_t>& p2, int dx, int dy, int N) {
+// Devuelve la franja del patrn que queda bajo un vecino desplazado (dx, dy), fila a fila; dos patrones son
+// compatibles en esa direccin si strip(p1, dx, dy) coincide con strip(p2, -dx, -dy)
+string OverlappingModel::strip(const uint8_t* p, int dx, int dy, int N) {
     int xmin = dx < 0 ? 0 : dx;
     int xmax = dx < 0 ? dx + N : N;
     int ymin = dy < 0 ? 0 : dy;
     int ymax = dy < 0 ? dy + N : N;
+    string result;
+    result.reserve((xmax - xmin) * (ymax - ymin));
     for (int y = ymin; y < ymax; y++) {
         for (int x = xmin; x < xmax; x++) {
-            if (p1[x + N * y] != p2[x - dx + N * (y - dy)]) {
-                return false;
-            }
+            result.push_back(static_cast<char>(p[x + N * y]));
         }
     }
-    return true;
+    return result;
 }
 
-void OverlappingModel::Save(const string& filename) {
+void OverlappingModel::Save(const Solver& solver, const string& filename) const {
     vector<int> bitmap(outputWidth * outputHeight, 0);
+    const vector<int>& observed = solver.Observed();
+    int waveStride = solver.Rules().waveStride;
 
     if (observed[0] >= 0) {
         for (int y = 0; y < outputHeight; y++) {
             int dy = (y < outputHeight - patternSize + 1) ? 0 : patternSize - 1;
             for (int x = 0; x < outputWidth; x++) {
                 int dx = (x < outputWidth - patternSize + 1) ? 0 : patternSize - 1;
-                bitmap[x + y * outputWidth] = colors[patterns[observed[x - dx + (y - dy) * outputWidth]][dx + dy * patternSize]];
+                bitmap[x + y * outputWidth] = colors[patterns.Pattern(observed[x - dx + (y - dy) * outputWidth])[dx + dy * patternSize]];
             }
         }
     }
     else {
-        for (size_t i = 0; i < wave.size(); i++) {
+        for (int i = 0; i < outputWidth * outputHeight; i++) {
             int contributors = 0, r = 0, g = 0, b = 0;
             int x = i % outputWidth;
             int y = i / outputWidth;
@@ -166,10 +153,11 @@ void OverlappingModel::Save(const string& filename) {
                     int sy = (y - dy + outputHeight) % outputHeight;
                     int s = sx + sy * outputWidth;
                     if (!periodic && (sx + patternSize > outputWidth || sy + patternSize > outputHeight || sx < 0 || sy < 0)) continue;
-                    for (int t = 0; t < patternsTotal; t++) {
-                        if (wave[s][t]) {
-                            contributors++;
-                            int argb = colors[patterns[t][dx + dy * patternSize]];
+                    const uint64_t* w = solver.Wave(s);
+                    for (int k = 0; k < waveStride; k++) {
+                        contributors += Popcount(w[k]);
+                        for (uint64_t bits = w[k]; bits; bits &= bits - 1) {
+                            int argb = colors[patterns.Pattern(k * 64 + CountTrailingZeros(bits))[dx + dy * patternSize]];
                             r += (argb & 0xff0000) >> 16;
                             g += (argb & 0xff00) >> 8;
                             b += argb & 0xff;
@@ -182,4 +170,11 @@ void OverlappingModel::Save(const string& filename) {
     }
 
     SaveBitmap(bitmap, outputWidth, outputHeight, filename);
+}
+
+// Cada celda es el origen de su patrn, as que basta con su pxel superior izquierdo
+void OverlappingModel::SaveObserved(const vector<int>& observed, int width, int height, const string& filename) const {
+    vector<int> bitmap(width * height);
+    for (int i = 0; i < width * height; i++) bitmap[i] = colors[patterns.Pattern(observed[i])[0]];
+    SaveBitmap(bitmap, width, height, filename);
 }
\ No newline at end of file
@@ -5,25 +5,28 @@
 
 #include "model.h"
 #include "bitmap_helper.h"
+#include "work_stealing_pool.h"
+#include "pattern_pool.h"
 
 using namespace std;
 
 class OverlappingModel : public Model {
 	
 private:
-	vector<vector<uint8_t>> patterns;
+	PatternPool patterns;
 	vector<int> colors;
 
-	static vector<uint8_t> pattern(function<uint8_t(int, int)> f, int N);
-	static vector<uint8_t> rotate(const vector<uint8_t>& p, int N);
-	static vector<uint8_t> reflect(const vector<uint8_t>& p, int N);
-	static int64_t hash(const vector<uint8_t>& p, int C);
+	static void rotate(const vector<uint8_t>& p, vector<uint8_t>& result, int N);
+	static void reflect(const vector<uint8_t>& p, vector<uint8_t>& result, int N);
 
-	static bool agrees(const vector<uint8_t>& p1, const vector<uint8_t>& p2, int dx, int dy, int N);
+	static string strip(const uint8_t* p, int dx, int dy, int N);
 
 public:
-	OverlappingModel(const string& name, int N, int width, int height, bool periodicInput, bool periodic, int symmetry, bool ground, Heuristic heuristic);
-	void Save(const string& filename) override;
+	// Los patrones se extraen y el propagador se construye con threads hilos; con 0 se usan todos los ncleos
+	OverlappingModel(const string& name, int N, int width, int height, bool periodicInput, bool periodic, int symmetry, bool ground, Heuristic heuristic, int threads = 0);
+	using Model::Save;
+	void Save(const Solver& solver, const string& filename) const override;
+	void SaveObserved(const vector<int>& observed, int width, int height, const string& filename) const override;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "pattern_pool.h"
+
+using namespace std;
+
+PatternPool::PatternPool(int patternBytes) : patternBytes(patternBytes) {
+    slots.assign(16, -1);
+}
+
+// FNV-1a byte a byte y una mezcla final para que los bits bajos, que eligen la posicin, dependan de todos
+uint64_t PatternPool::Hash(const uint8_t* p, int bytes) {
+    uint64_t h = 14695981039346656037ULL;
+    for (int i = 0; i < bytes; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+int PatternPool::Add(const uint8_t* p, uint64_t hash, double weight) {
+    size_t mask = slots.size() - 1;
+    for (size_t k = hash & mask;; k = (k + 1) & mask) {
+        int t = slots[k];
+        if (t < 0) {
+            t = Count();
+            slots[k] = t;
+            data.insert(data.end(), p, p + patternBytes);
+            hashes.push_back(hash);
+            weights.push_back(weight);
+
+            // Mantenemos la tabla ocupada como mucho a la mitad para que las secuencias de sondeo sean cortas
+            if (size_t(Count()) * 2 > slots.size()) Grow();
+            return t;
+        }
+        if (hashes[t] == hash && memcmp(Pattern(t), p, patternBytes) == 0) {
+            weights[t] += weight;
+            return t;
+        }
+    }
+}
+
+// Duplica la tabla y recoloca los patrones con los hashes guardados, sin volver a leer sus bytes
+void PatternPool::Grow() {
+    slots.assign(slots.size() * 2, -1);
+    size_t mask = slots.size() - 1;
+    for (int t = 0; t < Count(); ++t) {
+        size_t k = hashes[t] & mask;
+        while (slots[k] >= 0) k = (k + 1) & mask;
+        slots[k] = t;
+    }
+}
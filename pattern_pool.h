@@ -0,0 +1,42 @@
+#ifndef PATTERN_POOL_H
+#define PATTERN_POOL_H
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+
+// Patrones de tamao fijo guardados uno detrs de otro en un nico bloque, con su peso y una tabla
+// de direccionamiento abierto para encontrarlos. La tabla guarda el hash de 64 bits de cada patrn,
+// pero dos patrones solo se consideran iguales si coinciden todos sus bytes, as que una colisin no los mezcla
+class PatternPool {
+
+private:
+	int patternBytes;
+	vector<uint8_t> data;
+	vector<uint64_t> hashes;
+	vector<double> weights;
+
+	// ndice del patrn en cada posicin de la tabla, o -1 si est libre; la capacidad es potencia de dos
+	vector<int> slots;
+
+	void Grow();
+
+public:
+	explicit PatternPool(int patternBytes = 0);
+
+	static uint64_t Hash(const uint8_t* p, int bytes);
+
+	// Suma weight al patrn p, aadindolo al final si no estaba; devuelve su ndice
+	int Add(const uint8_t* p, double weight = 1.0) { return Add(p, Hash(p, patternBytes), weight); }
+	int Add(const uint8_t* p, uint64_t hash, double weight);
+
+	int Count() const { return static_cast<int>(weights.size()); }
+	const uint8_t* Pattern(int t) const { return &data[size_t(t) * patternBytes]; }
+	uint64_t PatternHash(int t) const { return hashes[t]; }
+	double Weight(int t) const { return weights[t]; }
+	const vector<double>& Weights() const { return weights; }
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include "propagator.h"
+
+using namespace std;
+
+Propagator::Propagator() : patternsTotal(0), wide(false), disjoint(true), maxCount(0), maxClassSize(0) {}
+
+// Compila las listas anidadas [direccin][patrn][vecino] que construyen los modelos,
+// guardando una sola vez cada lista distinta
+Propagator::Propagator(const vector<vector<vector<int>>>& lists)
+    : patternsTotal(static_cast<int>(lists[0].size())), disjoint(true), maxCount(0), maxClassSize(0)
+{
+    wide = patternsTotal > UINT16_MAX + 1;
+
+    for (int d = 0; d < 4; ++d) {
+        // Las listas se comparan ordenadas; las clases se numeran por orden de aparicin
+        map<vector<int>, uint32_t> ids;
+        vector<const vector<int>*> distinct;
+        classes[d].resize(patternsTotal);
+        for (int t = 0; t < patternsTotal; ++t) {
+            vector<int> list = lists[d][t];
+            sort(list.begin(), list.end());
+            auto [it, inserted] = ids.emplace(move(list), static_cast<uint32_t>(distinct.size()));
+            if (inserted) {
+                distinct.push_back(&it->first);
+                classSizes[d].push_back(0);
+            }
+            classes[d][t] = it->second;
+            maxClassSize = max(maxClassSize, static_cast<int>(++classSizes[d][it->second]));
+        }
+
+        size_t total = 0;
+        for (const vector<int>* list : distinct) total += list->size();
+        if (total > UINT32_MAX) throw runtime_error("Propagator too large for 32-bit offsets");
+
+        offsets[d].resize(distinct.size() + 1);
+        if (wide) wideNeighbors[d].reserve(total);
+        else narrowNeighbors[d].reserve(total);
+
+        vector<uint8_t> listed(patternsTotal, 0);
+        offsets[d][0] = 0;
+        for (size_t c = 0; c < distinct.size(); ++c) {
+            const vector<int>& list = *distinct[c];
+            for (int t2 : list) {
+                if (wide) wideNeighbors[d].push_back(static_cast<uint32_t>(t2));
+                else narrowNeighbors[d].push_back(static_cast<uint16_t>(t2));
+                if (listed[t2]++) disjoint = false;
+            }
+            offsets[d][c + 1] = offsets[d][c] + static_cast<uint32_t>(list.size());
+            maxCount = max(maxCount, static_cast<int>(list.size()));
+        }
+    }
+}
+
+void Propagator::Mark(int d, int t, uint64_t* mask) const {
+    uint32_t c = classes[d][t];
+    for (uint32_t l = offsets[d][c]; l < offsets[d][c + 1]; ++l) {
+        int t2 = wide ? int(wideNeighbors[d][l]) : int(narrowNeighbors[d][l]);
+        mask[t2 >> 6] |= 1ULL << (t2 & 63);
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef PROPAGATOR_H
+#define PROPAGATOR_H
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <map>
+
+using namespace std;
+
+// Propagador en formato CSR (compressed sparse row): para cada direccin, un vector de desplazamientos
+// y un vector empaquetado con todas las listas de patrones compatibles, una detrs de otra.
+// Los patrones con la misma lista en una direccin forman una clase y la lista se guarda una sola vez:
+// en el modelo por solapamiento son los que coinciden en la franja que comparten con el vecino
+class Propagator {
+
+private:
+	int patternsTotal;
+	bool wide, disjoint;
+	int maxCount, maxClassSize;
+
+	// Clase de cada patrn; desplazamientos y tamaos van por clase
+	vector<uint32_t> classes[4];
+	vector<uint32_t> offsets[4];
+	vector<uint32_t> classSizes[4];
+	vector<uint16_t> narrowNeighbors[4];
+	vector<uint32_t> wideNeighbors[4];
+
+public:
+	Propagator();
+	Propagator(const vector<vector<vector<int>>>& lists);
+
+	// Los ndices se guardan en 16 bits salvo que haya ms patrones de los que caben
+	bool IsWide() const { return wide; }
+	int MaxCount() const { return maxCount; }
+
+	// Cierto si en cada direccin ningn patrn aparece en las listas de dos clases distintas; entonces un patrn
+	// pierde todo el soporte de un vecino justo cuando a este no le queda ningn patrn de la clase que lo admite
+	bool IsDisjoint() const { return disjoint; }
+	int MaxClassSize() const { return maxClassSize; }
+
+	int ClassCount(int d) const { return static_cast<int>(classSizes[d].size()); }
+	int ClassSize(int d, int c) const { return classSizes[d][c]; }
+	const uint32_t* Classes(int d) const { return classes[d].data(); }
+
+	int Count(int d, int t) const { uint32_t c = classes[d][t]; return offsets[d][c + 1] - offsets[d][c]; }
+	const uint32_t* Offsets(int d) const { return offsets[d].data(); }
+
+	template <typename Index> const Index* Neighbors(int d) const;
+
+	// Activa en mask (una palabra de 64 bits por cada 64 patrones) los patrones compatibles con t en la direccin d
+	void Mark(int d, int t, uint64_t* mask) const;
+};
+
+template <>
+inline const uint16_t* Propagator::Neighbors<uint16_t>(int d) const { return narrowNeighbors[d].data(); }
+
+template <>
+inline const uint32_t* Propagator::Neighbors<uint32_t>(int d) const { return wideNeighbors[d].data(); }
+
+#endif
@@ -0,0 +1,73 @@
+#include "ruleset.h"
+#include "solver.h"
+
+using namespace std;
+
+const vector<int> Ruleset::directionX = { -1, 0, 1, 0 };
+const vector<int> Ruleset::directionY = { 0, 1, 0, -1 };
+const vector<int> Ruleset::opposite = { 2, 3, 0, 1 };
+
+// Calculamos los pesos y el estado de partida comn a todas las ejecuciones
+Ruleset::Ruleset(int width, int height, int N, bool periodic, bool ground, const vector<double>& weights, Propagator propagator, Engine engine)
+    : outputWidth(width), outputHeight(height), patternsTotal(weights.size()), patternSize(N), periodic(periodic), ground(ground),
+    weights(weights), propagator(move(propagator)), engine(engine), initialContradictionNode(-1) {
+    waveStride = (patternsTotal + 63) / 64;
+
+    // Con clases disjuntas cada contador cuenta los patrones de una clase que le quedan al vecino;
+    // si no, los patrones del vecino que admiten cada patrn, que son tantos como su lista de propagacin
+    classCounters = this->propagator.IsDisjoint();
+    counterStride = 0;
+    for (int d = 0; d < 4; ++d) {
+        counterBase[d] = counterStride;
+        counterStride += classCounters ? this->propagator.ClassCount(d) : patternsTotal;
+    }
+
+    // El ancho de los contadores de compatibilidad depende del mayor valor que puedan tomar
+    int maxSupport = classCounters ? this->propagator.MaxClassSize() : this->propagator.MaxCount();
+    counterBytes = maxSupport <= UINT8_MAX ? 1 : maxSupport <= UINT16_MAX ? 2 : 4;
+
+    weightLogWeights.resize(patternsTotal);
+    sumOfWeights = 0;
+    sumOfWeightLogWeights = 0;
+
+    for (int t = 0; t < patternsTotal; ++t) {
+        weightLogWeights[t] = weights[t] * log(weights[t]);
+        sumOfWeights += weights[t];
+        sumOfWeightLogWeights += weightLogWeights[t];
+    }
+
+    if (engine == Engine::Auto) this->engine = waveStride <= 2 ? Engine::Bitset : Engine::AC4;
+    if (this->engine == Engine::Bitset) {
+        supports.assign(size_t(4) * patternsTotal * waveStride, 0);
+        for (int d = 0; d < 4; ++d)
+            for (int t = 0; t < patternsTotal; ++t) this->propagator.Mark(d, t, &supports[(size_t(d) * patternsTotal + t) * waveStride]);
+    }
+
+    // Tablas de vecinos y de celdas observables
+    int cells = width * height;
+    neighbors.resize(size_t(cells) * 4);
+    observable.resize(cells);
+    for (int i = 0; i < cells; ++i) {
+        int x = i % width, y = i / width;
+        observable[i] = periodic || (x + N <= width && y + N <= height);
+        if (observable[i]) activeCells.push_back(i);
+
+        for (int d = 0; d < 4; ++d) {
+            int x2 = x + directionX[d], y2 = y + directionY[d];
+            if (!periodic && (x2 < 0 || y2 < 0 || x2 + N > width || y2 + N > height)) {
+                neighbors[i * 4 + d] = -1;
+                continue;
+            }
+
+            if (x2 < 0) x2 += width;
+            else if (x2 >= width) x2 -= width;
+            if (y2 < 0) y2 += height;
+            else if (y2 >= height) y2 -= height;
+            neighbors[i * 4 + d] = x2 + y2 * width;
+        }
+    }
+
+    // Un Solver provisional prohbe y propaga el suelo y nos deja el resultado
+    Solver builder(*this);
+    builder.BuildInitialState(*this);
+}
@@ -0,0 +1,78 @@
+#ifndef RULESET_H
+#define RULESET_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+#include "bit_helper.h"
+#include "propagator.h"
+
+using namespace std;
+
+// Datos de una celda que se leen y escriben juntos en cada prohibicin y en cada seleccin
+struct alignas(32) CellState {
+	double sumOfWeights, sumOfWeightLogWeights;
+	double noise;
+	int sumOfOnes;
+	uint8_t dirty;
+};
+
+// Datos inmutables de un modelo ya inicializado: dimensiones, pesos, propagador y estado de partida.
+// Se construye una sola vez y varios Solver pueden compartirlo desde distintos hilos
+class Ruleset {
+
+public:
+	// AC4 mantiene contadores de soporte por celda, direccin y patrn; Bitset recalcula el dominio de cada vecino
+	// como la interseccin con la unin de las mscaras de soporte, sin contadores. Auto elige Bitset cuando
+	// el dominio de una celda cabe en una o dos palabras y AC4 en otro caso
+	enum Engine { Auto, AC4, Bitset };
+
+	Ruleset(int width, int height, int N, bool periodic, bool ground, const vector<double>& weights, Propagator propagator, Engine engine = Auto);
+
+	int outputWidth, outputHeight, patternsTotal, patternSize;
+	bool periodic, ground;
+
+	vector<double> weights, weightLogWeights;
+	double sumOfWeights, sumOfWeightLogWeights;
+
+	Propagator propagator;
+	Engine engine;
+
+	// Solo con Bitset: para cada direccin d y patrn t, waveStride palabras con los patrones que admite el vecino en d
+	AlignedVector<uint64_t> supports;
+
+	const uint64_t* Support(int d, int t) const { return &supports[(size_t(d) * patternsTotal + t) * waveStride]; }
+
+	// Palabras de 64 bits por celda en la onda y bytes por contador de compatibilidad
+	int waveStride, counterBytes;
+
+	// Solo con AC4: si las clases del propagador son disjuntas hay un contador por celda, direccin y clase en lugar
+	// de uno por patrn. counterStride es el tamao del bloque de una celda y counterBase[d] el inicio de la direccin d
+	bool classCounters;
+	int counterStride, counterBase[4];
+
+	// Estado tras prohibir y propagar el suelo, que cada Solver copia en bloque al empezar una ejecucin.
+	// Si no hubo nada que prohibir, initialCompatible guarda solo el bloque de una celda, igual para todas
+	AlignedVector<uint64_t> initialWave;
+	vector<uint8_t> initialCompatible;
+	AlignedVector<CellState> initialStates;
+	int initialContradictionNode;
+
+	// Vecinos de cada celda en las cuatro direcciones ([celda][direccin], -1 si se sale de una salida no peridica)
+	// y celdas observables en orden de recorrido, precalculados para que los bucles de propagacin y seleccin
+	// no hagan divisiones ni comprobaciones de borde
+	vector<int32_t> neighbors;
+	vector<uint8_t> observable;
+	vector<int> activeCells;
+
+	int Neighbor(int i, int d) const { return neighbors[i * 4 + d]; }
+	const int32_t* Neighbors(int i) const { return &neighbors[i * 4]; }
+	bool IsObservable(int i) const { return observable[i]; }
+
+	static const vector<int> directionX;
+	static const vector<int> directionY;
+	static const vector<int> opposite;
+};
+
+#endif
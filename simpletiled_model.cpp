@@ -145,7 +145,6 @@ SimpleTiledModel::SimpleTiledModel(const string& name, const string& subsetName,
     patternsTotal = action.size();
     weights = weightList;
 
-    propagator = vector<vector<vector<int>>>(4, vector<vector<int>>(patternsTotal));
     vector<vector<vector<bool>>> densePropagator(4, vector<vector<bool>>(patternsTotal, vector<bool>(patternsTotal)));
 
     tinyxml2::XMLElement* xneighbor = root->FirstChildElement("neighbors")->FirstChildElement("neighbor");
@@ -203,15 +202,19 @@ SimpleTiledModel::SimpleTiledModel(const string& name, const string& subsetName,
             if (ST == 0) {
                 cerr << "ERROR: tile " << tilenames[t1] << " has no neighbors in direction " << d << endl;
             }
-
-            propagator[d][t1] = sp;
         }
     }
+
+    // Compilamos las listas al formato CSR compartido por ambos modelos
+    propagator = Propagator(sparsePropagator);
 }
 
 // Guardar el resultado como imagen
-void SimpleTiledModel::Save(const string& filename) {
+void SimpleTiledModel::Save(const Solver& solver, const string& filename) const {
     vector<int> bitmapData(outputWidth * outputHeight * tilesize * tilesize);
+    const vector<int>& observed = solver.Observed();
+    int waveStride = solver.Rules().waveStride;
+
     if (observed[0] >= 0) {
         for (int x = 0; x < outputWidth; ++x) {
             for (int y = 0; y < outputHeight; ++y) {
@@ -225,9 +228,9 @@ void SimpleTiledModel::Save(const string& filename) {
         }
     }
     else {
-        for (int i = 0; i < wave.size(); ++i) {
+        for (int i = 0; i < outputWidth * outputHeight; ++i) {
             int x = i % outputWidth, y = i / outputWidth;
-            if (blackBackground && sumsOfOnes[i] == patternsTotal) {
+            if (blackBackground && solver.SumOfOnes(i) == patternsTotal) {
                 for (int yt = 0; yt < tilesize; ++yt) {
                     for (int xt = 0; xt < tilesize; ++xt) {
                         bitmapData[x * tilesize + xt + (y * tilesize + yt) * outputWidth * tilesize] = 255 << 24;
@@ -235,14 +238,15 @@ void SimpleTiledModel::Save(const string& filename) {
                 }
             }
             else {
-                const vector<bool>& w = wave[i];
-                double normalization = 1.0 / sumsOfWeights[i];
+                const uint64_t* w = solver.Wave(i);
+                double normalization = 1.0 / solver.SumOfWeights(i);
                 for (int yt = 0; yt < tilesize; ++yt) {
                     for (int xt = 0; xt < tilesize; ++xt) {
                         int idi = x * tilesize + xt + (y * tilesize + yt) * outputWidth * tilesize;
                         double r = 0, g = 0, b = 0;
-                        for (int t = 0; t < patternsTotal; ++t) {
-                            if (w[t]) {
+                        for (int k = 0; k < waveStride; ++k) {
+                            for (uint64_t bits = w[k]; bits; bits &= bits - 1) {
+                                int t = k * 64 + CountTrailingZeros(bits);
                                 int argb = tiles[t][xt + yt * tilesize];
                                 r += ((argb & 0xff0000) >> 16) * weights[t] * normalization;
                                 g += ((argb & 0xff00) >> 8) * weights[t] * normalization;
@@ -259,6 +263,21 @@ void SimpleTiledModel::Save(const string& filename) {
     SaveBitmap(bitmapData, outputWidth * tilesize, outputHeight * tilesize, filename);
 }
 
+void SimpleTiledModel::SaveObserved(const vector<int>& observed, int width, int height, const string& filename) const {
+    vector<int> bitmapData(width * height * tilesize * tilesize);
+    for (int x = 0; x < width; ++x) {
+        for (int y = 0; y < height; ++y) {
+            const vector<int>& tile = tiles[observed[x + y * width]];
+            for (int dy = 0; dy < tilesize; ++dy) {
+                for (int dx = 0; dx < tilesize; ++dx) {
+                    bitmapData[x * tilesize + dx + (y * tilesize + dy) * width * tilesize] = tile[dx + dy * tilesize];
+                }
+            }
+        }
+    }
+    SaveBitmap(bitmapData, width * tilesize, height * tilesize, filename);
+}
+
 // Recibe una funcin desde rotate o reflect con la que procesar un tile dado para devolverlo rotado o reflejado
 vector<int> SimpleTiledModel::tile(function<int(int, int)> f, int size) {
     vector<int> result(size * size);
@@ -281,7 +300,8 @@ vector<int> SimpleTiledModel::reflect(const vector<int>& array, int size) {
 }
 
 // Generar salida en texto
-string SimpleTiledModel::TextOutput() const {
+string SimpleTiledModel::TextOutput(const Solver& solver) const {
+    const vector<int>& observed = solver.Observed();
     stringstream result;
     for (int y = 0; y < outputHeight; ++y) {
         for (int x = 0; x < outputWidth; ++x) {
@@ -35,8 +35,11 @@ private:
 public:
 	SimpleTiledModel(const string& name, const string& subsetName, int width, int height, bool periodic, bool blackBackground, Heuristic heuristic);
 
-	void Save(const string& filename) override;
-	string TextOutput() const;
+	using Model::Save;
+	void Save(const Solver& solver, const string& filename) const override;
+	void SaveObserved(const vector<int>& observed, int width, int height, const string& filename) const override;
+	string TextOutput(const Solver& solver) const;
+	string TextOutput() const { return TextOutput(*solver); }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,619 @@
+#include "solver.h"
+
+using namespace std;
+
+Solver::Solver(shared_ptr<const Ruleset> ruleset, Heuristic heuristic, int backtrackLimit)
+    : Solver(*ruleset) {
+    owner = move(ruleset);
+    this->heuristic = heuristic;
+    this->backtrackLimit = backtrackLimit;
+}
+
+// Reservamos las estructuras de datos que almacenan el estado actual del colapso de la funcin de onda
+Solver::Solver(const Ruleset& rules)
+    : rules(rules), observedSoFar(0), backtracks(0), contradictionNode(-1), heuristic(Heuristic::Scanline), backtrackLimit(0) {
+    int cells = rules.outputWidth * rules.outputHeight;
+    wave.resize(size_t(cells) * rules.waveStride);
+
+    // Con Bitset no hay contadores ni pila de pares, solo una cola de celdas. La pila de AC4 crece segn
+    // las prohibiciones pendientes de propagar, que en la prctica son un frente pequeo y no celdas x patrones
+    if (rules.engine == Ruleset::Engine::AC4) {
+        size_t counters = size_t(cells) * rules.counterStride;
+        if (rules.counterBytes == 1) compatible8.resize(counters);
+        else if (rules.counterBytes == 2) compatible16.resize(counters);
+        else compatible32.resize(counters);
+        stack.reserve(cells);
+    }
+    else {
+        changed.reserve(cells);
+        isChanged.resize(cells);
+        support.resize(rules.waveStride);
+    }
+
+    observed.resize(cells, -1);
+
+    cellStates.resize(cells);
+
+    candidates.Reset(cells);
+}
+
+// Calcula una sola vez el estado de partida, con el suelo y los patrones sin soporte ya prohibidos y propagados,
+// y lo guarda en el Ruleset para que Clear solo tenga que copiarlo en cada ejecucin
+void Solver::BuildInitialState(Ruleset& target) {
+    int T = rules.patternsTotal, stride = rules.waveStride;
+
+    // Todas las palabras quedan llenas salvo la ltima, que solo activa los patrones existentes
+    uint64_t lastWord = T % 64 == 0 ? ~0ULL : (1ULL << (T % 64)) - 1;
+    for (int i = 0; i < rules.outputWidth * rules.outputHeight; ++i) {
+        uint64_t* w = &wave[size_t(i) * stride];
+        fill(w, w + stride - 1, ~0ULL);
+        w[stride - 1] = lastWord;
+
+        cellStates[i] = { rules.sumOfWeights, rules.sumOfWeightLogWeights, 0.0, T, 0 };
+    }
+    contradictionNode = -1;
+
+    if (rules.engine == Ruleset::Engine::AC4) WithCounters([this](auto, auto& compatible) { ResetCompatible(compatible); });
+
+    bool banned = rules.engine == Ruleset::Engine::AC4 ? BanInitial<Ruleset::Engine::AC4>() : BanInitial<Ruleset::Engine::Bitset>();
+
+    target.initialWave = wave;
+    target.initialStates = cellStates;
+    target.initialContradictionNode = contradictionNode;
+
+    // Sin prohibiciones todas las celdas tienen los mismos contadores, as que basta con guardar el bloque de una
+    if (rules.engine == Ruleset::Engine::AC4) WithCounters([this, &target, banned](auto, auto& compatible) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(compatible.data());
+        size_t counters = banned ? compatible.size() : size_t(rules.counterStride);
+        target.initialCompatible.assign(bytes, bytes + counters * sizeof(compatible[0]));
+    });
+}
+
+// Prohbe el suelo y los patrones sin soporte y lo propaga; devuelve si hubo algo que prohibir.
+// Con la heurstica Scanline el montculo no se toca durante estas prohibiciones
+template <Ruleset::Engine E>
+bool Solver::BanInitial() {
+    int T = rules.patternsTotal, stride = rules.waveStride;
+    bool banned = false;
+    if (rules.ground) {
+        int width = rules.outputWidth, height = rules.outputHeight;
+        for (int x = 0; x < width; ++x) {
+            for (int t = 0; t < T - 1; ++t) Ban<Heuristic::Scanline, E, false>(x + (height - 1) * width, t);
+            for (int y = 0; y < height - 1; ++y) Ban<Heuristic::Scanline, E, false>(x + y * width, T - 1);
+        }
+        banned = true;
+    }
+
+    // Un patrn que no aparece en ninguna lista de la direccin d no tiene soporte en una celda con vecino en -d.
+    // AC4 nunca llegara a descontarlo y Bitset lo quitara con el primer cambio del vecino, as que se prohbe
+    // aqu para que ambos motores partan del mismo estado arco-consistente
+    vector<uint64_t> supported(stride);
+    for (int d = 0; d < 4; ++d) {
+        fill(supported.begin(), supported.end(), 0);
+        for (int t = 0; t < T; ++t) rules.propagator.Mark(d, t, supported.data());
+
+        vector<int> unsupported;
+        for (int t = 0; t < T; ++t)
+            if (!((supported[t >> 6] >> (t & 63)) & 1)) unsupported.push_back(t);
+        if (unsupported.empty()) continue;
+
+        for (int i1 = 0; i1 < rules.outputWidth * rules.outputHeight; ++i1) {
+            int i2 = rules.Neighbors(i1)[d];
+            if (i2 < 0) continue;
+            for (int t : unsupported)
+                if (IsPossible(i2, t)) Ban<Heuristic::Scanline, E, false>(i2, t);
+        }
+        banned = true;
+    }
+    if (banned) Propagate<Heuristic::Scanline, E, false>();
+    return banned;
+}
+
+// La heurstica, el motor y si hay rastro para volver atrs se resuelven aqu una sola vez; el resto del ncleo
+// se instancia para cada combinacin y no vuelve a consultarlos dentro de los bucles
+bool Solver::Run(int seed, int limit, const atomic<bool>* cancel) {
+    if (heuristic == Heuristic::Entropy) return RunWithEngine<Heuristic::Entropy>(seed, limit, cancel);
+    else if (heuristic == Heuristic::MRV) return RunWithEngine<Heuristic::MRV>(seed, limit, cancel);
+    else return RunWithEngine<Heuristic::Scanline>(seed, limit, cancel);
+}
+
+template <Solver::Heuristic H>
+bool Solver::RunWithEngine(int seed, int limit, const atomic<bool>* cancel) {
+    bool trail = backtrackLimit > 0;
+    if (rules.engine == Ruleset::Engine::AC4) {
+        if (trail) return RunWith<H, Ruleset::Engine::AC4, true>(seed, limit, cancel);
+        else return RunWith<H, Ruleset::Engine::AC4, false>(seed, limit, cancel);
+    }
+    else {
+        if (trail) return RunWith<H, Ruleset::Engine::Bitset, true>(seed, limit, cancel);
+        else return RunWith<H, Ruleset::Engine::Bitset, false>(seed, limit, cancel);
+    }
+}
+
+template <Solver::Heuristic H, Ruleset::Engine E, bool Trail>
+bool Solver::RunWith(int seed, int limit, const atomic<bool>* cancel) {
+    // Reiniciamos el tablero; solo se vuelve atrs si backtrackLimit lo permite
+    mt19937 random(seed);
+    Clear<H>(random);
+    backtracks = 0;
+
+    // Las restricciones externas no son decisiones, as que si contradicen no hay a dnde volver
+    if (!ApplyConstraints<H, E, Trail>()) return false;
+
+    // Definimos un nmero limitado de pasos y procedemos al funcionamiento estndar
+    for (int l = 0; l < limit || limit < 0; ++l) {
+        if (cancel && cancel->load(memory_order_relaxed)) return false;
+
+        int node = NextUnobservedNode<H>();
+        if (node >= 0) {
+            Observe<H, E, Trail>(node, random);
+            bool success = Propagate<H, E, Trail>();
+
+            // Ante una contradiccin deshacemos la ltima decisin y prohibimos el patrn que se eligi.
+            // La cancelacin se comprueba tambin aqu para no gastar el presupuesto de vueltas atrs en vano;
+            // la contradiccin an no es definitiva, as que se olvida para que quien llama vea una cancelacin
+            while (!success) {
+                if (decisions.empty() || backtracks >= backtrackLimit) return false;
+                if (cancel && cancel->load(memory_order_relaxed)) {
+                    contradictionNode = -1;
+                    return false;
+                }
+                Decision decision = decisions.back();
+                decisions.pop_back();
+
+                Undo<H, E>(decision.trailSize);
+                observedSoFar = decision.observedSoFar;
+                ++backtracks;
+
+                Ban<H, E, Trail>(decision.node, decision.pattern);
+                success = Propagate<H, E, Trail>();
+            }
+        }
+        else {
+            // Cada celda tiene un nico bit activo, que localizamos palabra a palabra
+            for (int i = 0; i < rules.outputWidth * rules.outputHeight; ++i) {
+                const uint64_t* w = &wave[size_t(i) * rules.waveStride];
+                for (int k = 0; k < rules.waveStride; ++k)
+                    if (w[k]) {
+                        observed[i] = k * 64 + CountTrailingZeros(w[k]);
+                        break;
+                    }
+            }
+            return true;
+        }
+    }
+
+    return true;
+}
+
+void Solver::Constrain(int i, const uint64_t* allowed) {
+    int stride = rules.waveStride;
+    if (constraints.empty()) {
+        constraints.assign(size_t(rules.outputWidth) * rules.outputHeight * stride, ~0ULL);
+        isConstrained.assign(size_t(rules.outputWidth) * rules.outputHeight, 0);
+    }
+
+    if (!isConstrained[i]) {
+        isConstrained[i] = 1;
+        constrainedCells.push_back(i);
+    }
+    uint64_t* mask = &constraints[size_t(i) * stride];
+    for (int k = 0; k < stride; ++k) mask[k] &= allowed[k];
+}
+
+void Solver::ConstrainPattern(int i, int t) {
+    constraintScratch.assign(rules.waveStride, 0);
+    constraintScratch[t >> 6] = 1ULL << (t & 63);
+    Constrain(i, constraintScratch.data());
+}
+
+void Solver::ConstrainNeighbor(int i, int d, int t) {
+    constraintScratch.assign(rules.waveStride, 0);
+    rules.propagator.Mark(d, t, constraintScratch.data());
+    Constrain(i, constraintScratch.data());
+}
+
+void Solver::ClearConstraints() {
+    for (int i : constrainedCells) {
+        fill_n(&constraints[size_t(i) * rules.waveStride], rules.waveStride, ~0ULL);
+        isConstrained[i] = 0;
+    }
+    constrainedCells.clear();
+}
+
+// Prohbe en cada celda restringida los patrones que su mscara no permite y propaga el resultado
+template <Solver::Heuristic H, Ruleset::Engine E, bool Trail>
+bool Solver::ApplyConstraints() {
+    if (constrainedCells.empty()) return contradictionNode < 0;
+
+    for (int i : constrainedCells) {
+        const uint64_t* mask = &constraints[size_t(i) * rules.waveStride];
+        uint64_t* w = &wave[size_t(i) * rules.waveStride];
+        for (int k = 0; k < rules.waveStride; ++k)
+            for (uint64_t bits = w[k] & ~mask[k]; bits; bits &= bits - 1) Ban<H, E, Trail>(i, k * 64 + CountTrailingZeros(bits));
+    }
+    return Propagate<H, E, Trail>();
+}
+
+template <Solver::Heuristic H>
+int Solver::NextUnobservedNode() {
+    if constexpr (H == Heuristic::Scanline) {
+        // observedSoFar es una posicin en la lista de celdas observables, no un ndice de celda.
+        // Se queda en la celda elegida y no en la siguiente: la decisin guarda este valor y, si se refuta,
+        // la bsqueda debe volver a esa celda, que puede conservar varios patrones
+        const vector<int>& active = rules.activeCells;
+        for (int k = observedSoFar; k < int(active.size()); ++k) {
+            int i = active[k];
+            if (cellStates[i].sumOfOnes > 1) {
+                observedSoFar = k;
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // El montculo solo contiene celdas observables con ms de un patrn posible
+    UpdateCandidates<H>();
+    return candidates.Empty() ? -1 : candidates.Top();
+}
+
+// Entropa (o nmero de patrones restantes en MRV) ms el ruido fijo de la celda para desempatar.
+// La entropa se calcula a partir de las sumas acumuladas, as que MRV no llega a calcular ningn logaritmo
+template <Solver::Heuristic H>
+double Solver::SelectionKey(int i) const {
+    const CellState& cell = cellStates[i];
+    double value;
+    if constexpr (H == Heuristic::Entropy) value = log(cell.sumOfWeights) - cell.sumOfWeightLogWeights / cell.sumOfWeights;
+    else value = cell.sumOfOnes;
+    return value + cell.noise;
+}
+
+// Se llama en cada prohibicin, as que tambin se pide inline
+template <Solver::Heuristic H>
+inline void Solver::MarkDirty(int i) {
+    if constexpr (H == Heuristic::Scanline) return;
+    if (cellStates[i].dirty) return;
+    cellStates[i].dirty = 1;
+    dirty.push_back(i);
+}
+
+// Recoloca en el montculo las celdas marcadas, con una sola actualizacin por celda aunque perdiera muchos patrones
+template <Solver::Heuristic H>
+void Solver::UpdateCandidates() {
+    for (int i : dirty) {
+        cellStates[i].dirty = 0;
+        if (rules.IsObservable(i) && cellStates[i].sumOfOnes > 1) {
+            if (candidates.Contains(i)) candidates.Update(i, SelectionKey<H>(i));
+            else candidates.Push(i, SelectionKey<H>(i));
+        }
+        else if (candidates.Contains(i)) candidates.Remove(i);
+    }
+    dirty.clear();
+}
+
+template <Solver::Heuristic H, Ruleset::Engine E, bool Trail>
+void Solver::Observe(int node, mt19937& random) {
+    uint64_t* w = &wave[size_t(node) * rules.waveStride];
+
+    // Un solo nmero uniforme sobre el peso total de la celda, que ya llevamos acumulado; recorremos los bits activos
+    // restando pesos hasta pasarnos. Si el redondeo de la suma deja x sin agotar, se queda el ltimo patrn activo
+    double x = uniform_real_distribution<double>(0.0, cellStates[node].sumOfWeights)(random);
+    int r = -1;
+    for (int k = 0; k < rules.waveStride && x >= 0; ++k)
+        for (uint64_t bits = w[k]; bits && x >= 0; bits &= bits - 1) {
+            r = k * 64 + CountTrailingZeros(bits);
+            x -= rules.weights[r];
+        }
+
+    // Con backtracking, la decisin marca el punto del rastro al que habr que volver
+    if constexpr (Trail) decisions.push_back({ trail.size(), node, r, observedSoFar });
+
+    Collapse<H, E, Trail>(node, r);
+}
+
+// Deja solo el patrn r en la celda de una vez: limpia sus palabras, fija sus sumas a las de r
+// y encola juntos todos los patrones retirados para que Propagate descuente su soporte
+template <Solver::Heuristic H, Ruleset::Engine E, bool Trail>
+void Solver::Collapse(int i, int r) {
+    uint64_t* w = &wave[size_t(i) * rules.waveStride];
+    for (int k = 0; k < rules.waveStride; ++k) {
+        uint64_t keep = k == r >> 6 ? 1ULL << (r & 63) : 0;
+        for (uint64_t bits = w[k] & ~keep; bits; bits &= bits - 1) {
+            int t = k * 64 + CountTrailingZeros(bits);
+            if constexpr (E == Ruleset::Engine::AC4) stack.push_back({ i, t });
+            if constexpr (Trail) trail.push_back({ i, t });
+        }
+        w[k] = keep;
+    }
+
+    if constexpr (E == Ruleset::Engine::Bitset) {
+        if (!isChanged[i]) {
+            isChanged[i] = 1;
+            changed.push_back(i);
+        }
+    }
+
+    CellState& cell = cellStates[i];
+    cell.sumOfOnes = 1;
+    cell.sumOfWeights = rules.weights[r];
+    cell.sumOfWeightLogWeights = rules.weightLogWeights[r];
+    MarkDirty<H>(i);
+}
+
+// Llama a f con un valor del tipo de ndice del propagador y con el vector de contadores activo
+template <typename F>
+void Solver::WithCounters(F f) {
+    if (rules.propagator.IsWide()) {
+        if (rules.counterBytes == 1) f(uint32_t(), compatible8);
+        else if (rules.counterBytes == 2) f(uint32_t(), compatible16);
+        else f(uint32_t(), compatible32);
+    }
+    else {
+        if (rules.counterBytes == 1) f(uint16_t(), compatible8);
+        else if (rules.counterBytes == 2) f(uint16_t(), compatible16);
+        else f(uint16_t(), compatible32);
+    }
+}
+
+// Devuelve false en cuanto una celda se queda sin patrones; la celda queda en contradictionNode
+template <Solver::Heuristic H, Ruleset::Engine E, bool Trail>
+bool Solver::Propagate() {
+    if constexpr (E == Ruleset::Engine::Bitset) {
+        // Con hasta 64 o 128 patrones el dominio cabe en una o dos palabras y los bucles se desenrollan
+        if (rules.waveStride == 1) PropagateBits<1, H, Trail>();
+        else if (rules.waveStride == 2) PropagateBits<2, H, Trail>();
+        else PropagateBits<0, H, Trail>();
+    }
+    else if (rules.classCounters) WithCounters([this](auto index, auto& compatible) { PropagateWith<H, Trail, true, decltype(index)>(compatible); });
+    else WithCounters([this](auto index, auto& compatible) { PropagateWith<H, Trail, false, decltype(index)>(compatible); });
+    return contradictionNode < 0;
+}
+
+// Motor de bits (AC-3): cuando una celda cambia, cada vecino se queda con la interseccin de su dominio y la unin
+// de las mscaras de soporte de los patrones que le quedan a la celda. Llega al mismo punto fijo que AC4.
+// Words fija en compilacin el nmero de palabras por celda; con 0 se usa waveStride
+template <int Words, Solver::Heuristic H, bool Trail>
+void Solver::PropagateBits() {
+    const int stride = Words > 0 ? Words : rules.waveStride;
+    uint64_t local[Words > 0 ? Words : 1];
+    uint64_t* sup = Words > 0 ? local : support.data();
+
+    while (!changed.empty()) {
+        int i1 = changed.back();
+        changed.pop_back();
+        isChanged[i1] = 0;
+        const uint64_t* w1 = &wave[size_t(i1) * stride];
+
+        const int32_t* next = rules.Neighbors(i1);
+        for (int d = 0; d < 4; ++d) {
+            int i2 = next[d];
+            if (i2 < 0) continue;
+
+            // Las mscaras son palabras contiguas y alineadas, as que el compilador vectoriza el OR
+            fill_n(sup, stride, 0);
+            for (int k = 0; k < stride; ++k)
+                for (uint64_t bits = w1[k]; bits; bits &= bits - 1) {
+                    const uint64_t* mask = rules.Support(d, k * 64 + CountTrailingZeros(bits));
+                    for (int j = 0; j < stride; ++j) sup[j] |= mask[j];
+                }
+
+            const uint64_t* w2 = &wave[size_t(i2) * stride];
+            for (int k = 0; k < stride; ++k)
+                for (uint64_t bits = w2[k] & ~sup[k]; bits; bits &= bits - 1) Ban<H, Ruleset::Engine::Bitset, Trail>(i2, k * 64 + CountTrailingZeros(bits));
+
+            // Sin contadores no hay nada que descontar, as que con o sin backtracking se abandona en el acto
+            if (contradictionNode >= 0) {
+                for (int i : changed) isChanged[i] = 0;
+                changed.clear();
+                return;
+            }
+        }
+    }
+}
+
+// Los contadores de una celda estn contiguos por direccin: [celda][direccin][patrn o clase]
+// y las listas del propagador se recorren directamente sobre el vector empaquetado.
+// Con Classes (clases disjuntas) cada prohibicin descuenta un solo contador por direccin, el de su clase, y solo
+// cuando este llega a cero se recorre la lista: todos sus patrones acaban de perder el ltimo soporte en esa direccin
+template <Solver::Heuristic H, bool Trail, bool Classes, typename Index, typename Counter>
+void Solver::PropagateWith(vector<Counter>& compatible) {
+    const Propagator& propagator = rules.propagator;
+    size_t stride = rules.counterStride;
+
+    while (!stack.empty() && contradictionNode < 0) {
+        auto [i1, t1] = stack.back();
+        stack.pop_back();
+
+        const int32_t* next = rules.Neighbors(i1);
+        for (int d = 0; d < 4; ++d) {
+            int i2 = next[d];
+            if (i2 < 0) continue;
+
+            uint32_t c = propagator.Classes(d)[t1];
+            Counter* comp = &compatible[i2 * stride + rules.counterBase[d]];
+            if constexpr (Classes) {
+                if (--comp[c] != 0) continue;
+            }
+
+            const Index* neighbors = propagator.Neighbors<Index>(d);
+            const uint32_t* offsets = propagator.Offsets(d);
+            for (uint32_t l = offsets[c]; l < offsets[c + 1]; ++l) {
+                int t2 = neighbors[l];
+                if constexpr (!Classes) {
+                    if (--comp[t2] != 0) continue;
+                }
+
+                // Un patrn ya prohibido puede seguir perdiendo soporte, as que solo se prohbe si sigue activo
+                if (!IsPossible(i2, t2)) continue;
+                Ban<H, Ruleset::Engine::AC4, Trail>(i2, t2);
+
+                // Sin backtracking el estado se descarta entero, as que se abandona en el acto
+                if (!Trail && contradictionNode >= 0) {
+                    stack.clear();
+                    return;
+                }
+            }
+        }
+    }
+
+    // Con backtracking, Undo devuelve el soporte de todo el rastro, as que aplicamos sin prohibir nada ms
+    // los descuentos de las prohibiciones que quedaron en la pila
+    while (!stack.empty()) {
+        auto [i1, t1] = stack.back();
+        stack.pop_back();
+
+        const int32_t* next = rules.Neighbors(i1);
+        for (int d = 0; d < 4; ++d) {
+            int i2 = next[d];
+            if (i2 < 0) continue;
+
+            uint32_t c = propagator.Classes(d)[t1];
+            Counter* comp = &compatible[i2 * stride + rules.counterBase[d]];
+            if constexpr (Classes) --comp[c];
+            else {
+                const Index* neighbors = propagator.Neighbors<Index>(d);
+                const uint32_t* offsets = propagator.Offsets(d);
+                for (uint32_t l = offsets[c]; l < offsets[c + 1]; ++l) --comp[neighbors[l]];
+            }
+        }
+    }
+}
+
+// Deshace las prohibiciones del rastro posteriores a trailSize, en orden inverso
+template <Solver::Heuristic H, Ruleset::Engine E>
+void Solver::Undo(size_t trailSize) {
+    if constexpr (E == Ruleset::Engine::AC4) {
+        if (rules.classCounters) WithCounters([this, trailSize](auto index, auto& compatible) { UndoWith<H, true, decltype(index)>(compatible, trailSize); });
+        else WithCounters([this, trailSize](auto index, auto& compatible) { UndoWith<H, false, decltype(index)>(compatible, trailSize); });
+    }
+    else {
+        while (trail.size() > trailSize) {
+            Restore<H>(trail.back().first, trail.back().second);
+            trail.pop_back();
+        }
+    }
+    contradictionNode = -1;
+}
+
+// Todas las prohibiciones del rastro ya se propagaron, as que devolvemos a los vecinos el soporte que perdieron
+template <Solver::Heuristic H, bool Classes, typename Index, typename Counter>
+void Solver::UndoWith(vector<Counter>& compatible, size_t trailSize) {
+    const Propagator& propagator = rules.propagator;
+    size_t stride = rules.counterStride;
+
+    while (trail.size() > trailSize) {
+        auto [i1, t1] = trail.back();
+        trail.pop_back();
+        Restore<H>(i1, t1);
+
+        const int32_t* next = rules.Neighbors(i1);
+        for (int d = 0; d < 4; ++d) {
+            int i2 = next[d];
+            if (i2 < 0) continue;
+
+            uint32_t c = propagator.Classes(d)[t1];
+            Counter* comp = &compatible[i2 * stride + rules.counterBase[d]];
+            if constexpr (Classes) {
+                ++comp[c];
+                continue;
+            }
+
+            const Index* neighbors = propagator.Neighbors<Index>(d);
+            const uint32_t* offsets = propagator.Offsets(d);
+            for (uint32_t l = offsets[c]; l < offsets[c + 1]; ++l) ++comp[neighbors[l]];
+        }
+    }
+}
+
+// Vuelve a activar un patrn prohibido, sin tocar los contadores de los vecinos
+template <Solver::Heuristic H>
+void Solver::Restore(int i, int t) {
+    wave[size_t(i) * rules.waveStride + (t >> 6)] |= 1ULL << (t & 63);
+    CellState& cell = cellStates[i];
+    cell.sumOfOnes += 1;
+    cell.sumOfWeights += rules.weights[t];
+    cell.sumOfWeightLogWeights += rules.weightLogWeights[t];
+    MarkDirty<H>(i);
+}
+
+// Marca un patrn como imposible en una determinada celda. Es lo que ms se llama en la propagacin, as que
+// se pide inline: con una instancia por motor y rastro el compilador deja de hacerlo por su cuenta
+template <Solver::Heuristic H, Ruleset::Engine E, bool Trail>
+inline void Solver::Ban(int i, int t) {
+    wave[size_t(i) * rules.waveStride + (t >> 6)] &= ~(1ULL << (t & 63));
+    if constexpr (E == Ruleset::Engine::AC4) stack.push_back({ i, t });
+    else if (!isChanged[i]) {
+        isChanged[i] = 1;
+        changed.push_back(i);
+    }
+    if constexpr (Trail) trail.push_back({ i, t });
+
+    CellState& cell = cellStates[i];
+    cell.sumOfOnes -= 1;
+    cell.sumOfWeights -= rules.weights[t];
+    cell.sumOfWeightLogWeights -= rules.weightLogWeights[t];
+
+    // Una celda vaca es una contradiccin y la propagacin debe detenerse
+    if (cell.sumOfOnes == 0 && contradictionNode < 0) contradictionNode = i;
+
+    MarkDirty<H>(i);
+}
+
+// Restauramos en bloque el estado inicial que guarda el Ruleset
+template <Solver::Heuristic H>
+void Solver::Clear(mt19937& random) {
+    wave = rules.initialWave;
+    cellStates = rules.initialStates;
+    contradictionNode = rules.initialContradictionNode;
+    if (rules.engine == Ruleset::Engine::AC4) WithCounters([this](auto, auto& compatible) {
+        using Counter = typename remove_reference_t<decltype(compatible)>::value_type;
+        if (rules.initialCompatible.size() == compatible.size() * sizeof(Counter))
+            memcpy(compatible.data(), rules.initialCompatible.data(), rules.initialCompatible.size());
+        else FillCompatible(compatible, reinterpret_cast<const Counter*>(rules.initialCompatible.data()));
+    });
+
+    fill(observed.begin(), observed.end(), -1);
+    observedSoFar = 0;
+    stack.clear();
+    for (int i : changed) isChanged[i] = 0;
+    changed.clear();
+
+    // El ruido de desempate se fija por celda al principio de cada ejecucin
+    int cells = rules.outputWidth * rules.outputHeight;
+    for (int i : dirty) cellStates[i].dirty = 0;
+    dirty.clear();
+    if constexpr (H != Heuristic::Scanline) {
+        uniform_real_distribution<double> unit(0.0, 1.0);
+        candidates.Reset(cells);
+        for (int i = 0; i < cells; ++i) {
+            cellStates[i].noise = 1E-6 * unit(random);
+            if (rules.IsObservable(i) && cellStates[i].sumOfOnes > 1) candidates.Push(i, SelectionKey<H>(i));
+        }
+    }
+
+    trail.clear();
+    decisions.clear();
+}
+
+// El bloque inicial de contadores es el mismo para todas las celdas, as que se construye una vez y se copia.
+// Por clase, el vecino empieza con todos los patrones de la clase; por patrn, con todos los que lo admiten
+template <typename Counter>
+void Solver::ResetCompatible(vector<Counter>& compatible) {
+    const Propagator& propagator = rules.propagator;
+    vector<Counter> block(rules.counterStride);
+    for (int d = 0; d < 4; ++d) {
+        Counter* base = &block[rules.counterBase[d]];
+        if (rules.classCounters)
+            for (int c = 0; c < propagator.ClassCount(d); ++c) base[c] = static_cast<Counter>(propagator.ClassSize(d, c));
+        else
+            for (int t = 0; t < rules.patternsTotal; ++t) base[t] = static_cast<Counter>(propagator.Count(Ruleset::opposite[d], t));
+    }
+    FillCompatible(compatible, block.data());
+}
+
+// Copia en todas las celdas el mismo bloque de contadores
+template <typename Counter>
+void Solver::FillCompatible(vector<Counter>& compatible, const Counter* block) {
+    size_t stride = rules.counterStride;
+    for (size_t i = 0; i < size_t(rules.outputWidth) * rules.outputHeight; ++i) copy_n(block, stride, compatible.begin() + i * stride);
+}
@@ -0,0 +1,140 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+
+#include "bit_helper.h"
+#include "ruleset.h"
+#include "indexed_heap.h"
+
+using namespace std;
+
+// Estado mutable de una ejecucin sobre un Ruleset compartido; cada hilo debe usar su propio Solver
+class Solver {
+
+	friend class Ruleset;
+
+public:
+	enum Heuristic { Entropy, MRV, Scanline };
+
+private:
+	shared_ptr<const Ruleset> owner;
+	const Ruleset& rules;
+
+	explicit Solver(const Ruleset& rules);
+
+	// El ncleo se instancia para cada heurstica (H), motor (E) y segn se guarde rastro para volver atrs (Trail),
+	// y en AC4 para cada ancho de ndice y de contador, de modo que los bucles internos no comprueban opciones
+	// que no cambian durante la ejecucin
+	template <Heuristic H> bool RunWithEngine(int seed, int limit, const atomic<bool>* cancel);
+	template <Heuristic H, Ruleset::Engine E, bool Trail> bool RunWith(int seed, int limit, const atomic<bool>* cancel);
+	template <Heuristic H> int NextUnobservedNode();
+	template <Heuristic H> double SelectionKey(int i) const;
+	template <Heuristic H> void MarkDirty(int i);
+	template <Heuristic H> void UpdateCandidates();
+	template <Heuristic H, Ruleset::Engine E, bool Trail> void Observe(int node, mt19937& random);
+	template <Heuristic H, Ruleset::Engine E, bool Trail> bool Propagate();
+	template <int Words, Heuristic H, bool Trail> void PropagateBits();
+	template <Heuristic H, Ruleset::Engine E, bool Trail> void Ban(int i, int t);
+	template <Heuristic H> void Restore(int i, int t);
+	template <Heuristic H, Ruleset::Engine E, bool Trail> void Collapse(int i, int r);
+	void BuildInitialState(Ruleset& target);
+	template <Ruleset::Engine E> bool BanInitial();
+	template <Heuristic H> void Clear(mt19937& random);
+	template <Heuristic H, Ruleset::Engine E, bool Trail> bool ApplyConstraints();
+
+	template <Heuristic H, Ruleset::Engine E> void Undo(size_t trailSize);
+
+	template <typename F> void WithCounters(F f);
+	template <Heuristic H, bool Trail, bool Classes, typename Index, typename Counter> void PropagateWith(vector<Counter>& compatible);
+	template <Heuristic H, bool Classes, typename Index, typename Counter> void UndoWith(vector<Counter>& compatible, size_t trailSize);
+	template <typename Counter> void ResetCompatible(vector<Counter>& compatible);
+	template <typename Counter> void FillCompatible(vector<Counter>& compatible, const Counter* block);
+
+	// Cada celda ocupa waveStride palabras de 64 bits, un bit por patrn
+	AlignedVector<uint64_t> wave;
+
+	// Contadores de soporte en un bloque plano [celda][direccin][patrn o clase], de 1, 2 o 4 bytes segn el Ruleset
+	vector<uint8_t> compatible8;
+	vector<uint16_t> compatible16;
+	vector<uint32_t> compatible32;
+
+	vector<int> observed;
+
+	// Prohibiciones (celda, patrn) cuyo soporte falta descontar; cada par entra una sola vez porque un patrn
+	// solo se prohbe si sigue activo, y clear conserva la capacidad entre ejecuciones
+	vector<pair<int, int>> stack;
+	int observedSoFar;
+
+	// Con Bitset la cola guarda celdas que han cambiado, cada una a lo sumo una vez, en lugar de pares (celda, patrn)
+	vector<int> changed;
+	vector<uint8_t> isChanged;
+	AlignedVector<uint64_t> support;
+
+	// Sumas, ruido y marca de cada celda juntos en un registro de 32 bytes: Ban y la seleccin tocan una sola lnea de cach
+	AlignedVector<CellState> cellStates;
+
+	// Celdas candidatas a observar ordenadas por entropa (o MRV) ms el ruido fijo de cada celda
+	IndexedHeap candidates;
+
+	// Celdas cuyos patrones cambiaron desde la ltima seleccin; su clave se recalcula solo al elegir la siguiente celda
+	vector<int> dirty;
+
+	// Rastro de prohibiciones y puntos de decisin para poder deshacerlas al encontrar una contradiccin
+	struct Decision {
+		size_t trailSize;
+		int node, pattern, observedSoFar;
+	};
+	vector<pair<int, int>> trail;
+	vector<Decision> decisions;
+	int backtracks;
+
+	// Celda que se qued sin patrones en la ltima propagacin, o -1 si no hubo contradiccin
+	int contradictionNode;
+
+	// Patrones permitidos en las celdas restringidas desde fuera, que Run aplica tras Clear en cada ejecucin
+	vector<int> constrainedCells;
+	vector<uint8_t> isConstrained;
+	AlignedVector<uint64_t> constraints;
+	vector<uint64_t> constraintScratch;
+
+public:
+	Heuristic heuristic;
+
+	// Nmero mximo de vueltas atrs por ejecucin; con 0 una contradiccin termina la ejecucin
+	int backtrackLimit;
+
+	Solver(shared_ptr<const Ruleset> ruleset, Heuristic heuristic, int backtrackLimit = 0);
+
+	// Si cancel se activa desde otro hilo, la ejecucin se abandona en el siguiente paso y devuelve false
+	bool Run(int seed, int limit, const atomic<bool>* cancel = nullptr);
+
+	// Limita la celda i a los patrones activos en allowed (waveStride palabras); varias llamadas se acumulan
+	void Constrain(int i, const uint64_t* allowed);
+	void ClearConstraints();
+
+	// Atajos: fijar el patrn t en la celda i, o limitarla a lo compatible con un vecino fijo con el patrn t
+	// del que la celda i queda en la direccin d
+	void ConstrainPattern(int i, int t);
+	void ConstrainNeighbor(int i, int d, int t);
+
+	const Ruleset& Rules() const { return rules; }
+	const vector<int>& Observed() const { return observed; }
+	const uint64_t* Wave(int i) const { return &wave[size_t(i) * rules.waveStride]; }
+	int SumOfOnes(int i) const { return cellStates[i].sumOfOnes; }
+	double SumOfWeights(int i) const { return cellStates[i].sumOfWeights; }
+
+	int Backtracks() const { return backtracks; }
+	int ContradictionNode() const { return contradictionNode; }
+
+	bool IsPossible(int i, int t) const { return (wave[size_t(i) * rules.waveStride + (t >> 6)] >> (t & 63)) & 1; }
+};
+
+#endif
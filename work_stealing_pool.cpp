@@ -0,0 +1,60 @@
+#include "work_stealing_pool.h"
+
+using namespace std;
+
+WorkStealingPool::WorkStealingPool(int threads) {
+    if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+    this->threads = threads;
+    for (int w = 0; w < threads; ++w) queues.push_back(make_unique<Queue>());
+}
+
+bool WorkStealingPool::Pop(int worker, int& task) {
+    Queue& queue = *queues[worker];
+    lock_guard<mutex> guard(queue.lock);
+    if (queue.tasks.empty()) return false;
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+// Recorre las colas ajenas empezando por la siguiente para no cargar siempre contra la misma
+bool WorkStealingPool::Steal(int worker, int& task) {
+    for (int k = 1; k < threads; ++k) {
+        Queue& queue = *queues[(worker + k) % threads];
+        lock_guard<mutex> guard(queue.lock);
+        if (queue.tasks.empty()) continue;
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::Run(int count, const function<void(int, int)>& f) {
+    // Con menos tareas que hilos solo trabajan los primeros workers, as que el resto nunca ve una tarea
+    int active = min(threads, count);
+    if (active <= 0) return;
+
+    // Cada hilo empieza con un bloque contiguo de tareas; el robo corrige el desequilibrio
+    for (int w = 0; w < active; ++w) {
+        int begin = static_cast<int>(static_cast<long long>(count) * w / active);
+        int end = static_cast<int>(static_cast<long long>(count) * (w + 1) / active);
+        for (int task = begin; task < end; ++task) queues[w]->tasks.push_back(task);
+    }
+
+    // No se aaden tareas durante el lote, as que un hilo que no encuentra nada que robar ya ha terminado
+    auto work = [this, &f](int worker) {
+        int task;
+        while (Pop(worker, task) || Steal(worker, task)) f(worker, task);
+    };
+
+    if (active == 1) {
+        work(0);
+        return;
+    }
+
+    vector<thread> pool;
+    for (int w = 1; w < active; ++w) pool.emplace_back(work, w);
+    work(0);
+    for (thread& t : pool) t.join();
+}
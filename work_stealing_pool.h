@@ -0,0 +1,40 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <functional>
+
+using namespace std;
+
+// Reparte un lote de tareas independientes entre varios hilos. Cada hilo tiene su propia cola:
+// saca tareas del principio de la suya y, cuando se vaca, roba del final de las de los dems
+class WorkStealingPool {
+
+private:
+	struct Queue {
+		mutex lock;
+		deque<int> tasks;
+	};
+
+	int threads;
+	vector<unique_ptr<Queue>> queues;
+
+	bool Pop(int worker, int& task);
+	bool Steal(int worker, int& task);
+
+public:
+	// Con 0 hilos se usan todos los ncleos disponibles
+	explicit WorkStealingPool(int threads);
+
+	int Size() const { return threads; }
+
+	// Ejecuta f(worker, task) para cada task en [0, count) y vuelve cuando han terminado todas, con
+	// min(Size(), count) hilos. Un mismo worker nunca ejecuta dos tareas a la vez, as que puede tener estado propio
+	void Run(int count, const function<void(int, int)>& f);
+};
+
+#endif